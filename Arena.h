@@ -0,0 +1,167 @@
+#ifndef MUTH_ARENA_H
+#define MUTH_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Size of the blocks an Arena requests from the global allocator. Larger
+// requests get a block of their own.
+#ifndef MUTH_ARENA_BLOCK_SIZE
+#define MUTH_ARENA_BLOCK_SIZE (1024 * 1024)
+#endif
+
+namespace Muth
+{
+
+    // Bump allocator over a list of 64-byte aligned blocks. Individual frees
+    // are no-ops; memory comes back in bulk by rewinding to a mark or with
+    // reset(), and blocks are kept for reuse. Not thread safe: each thread
+    // uses its own (see thread_arena()).
+    class Arena
+    {
+    public:
+        static constexpr size_t block_alignment = 64;
+
+        // Position to rewind to: everything allocated after it is released.
+        struct Mark
+        {
+            size_t block;
+            size_t offset;
+        };
+
+    public:
+        explicit Arena(size_t block_size = MUTH_ARENA_BLOCK_SIZE) : block_size(block_size) {}
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+        ~Arena() { release(); }
+
+        void *allocate(size_t bytes, size_t alignment);
+
+        Mark mark() const { return { current, offset }; }
+        void rewind(const Mark &to);
+        void reset() { rewind({ 0, 0 }); }
+        // Returns every block to the global allocator.
+        void release();
+
+        // Bytes handed out since the last reset, not counting alignment gaps
+        // in earlier blocks.
+        size_t used() const;
+        size_t reserved() const;
+
+    private:
+        struct Block
+        {
+            char *data;
+            size_t size;
+        };
+
+        size_t block_size;
+        std::vector<Block> blocks;
+        size_t current = 0;
+        size_t offset = 0;
+    };
+
+    inline void *Arena::allocate(size_t bytes, size_t alignment)
+    {
+        while (current < blocks.size())
+        {
+            const Block &block = blocks[current];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+            const size_t start = ((base + offset + alignment - 1) & ~uintptr_t(alignment - 1)) - base;
+            if (start + bytes <= block.size)
+            {
+                offset = start + bytes;
+                return block.data + start;
+            }
+            current++;
+            offset = 0;
+        }
+        const size_t size = bytes + alignment > block_size ? bytes + alignment : block_size;
+        char *data = static_cast<char *>(::operator new(size, std::align_val_t(block_alignment)));
+        blocks.push_back({ data, size });
+        current = blocks.size() - 1;
+        const size_t start = alignment > block_alignment ? (alignment - reinterpret_cast<uintptr_t>(data) % alignment) % alignment : 0;
+        offset = start + bytes;
+        return data + start;
+    }
+
+    inline void Arena::rewind(const Mark &to)
+    {
+        current = to.block;
+        offset = to.offset;
+    }
+
+    inline void Arena::release()
+    {
+        for (const Block &block : blocks)
+            ::operator delete(block.data, std::align_val_t(block_alignment));
+        blocks.clear();
+        current = 0;
+        offset = 0;
+    }
+
+    inline size_t Arena::used() const
+    {
+        size_t total = offset;
+        for (size_t i = 0; i < current && i < blocks.size(); i++)
+            total += blocks[i].size;
+        return total;
+    }
+
+    inline size_t Arena::reserved() const
+    {
+        size_t total = 0;
+        for (const Block &block : blocks)
+            total += block.size;
+        return total;
+    }
+
+    // Arena heap storage draws from on this thread; null means the global
+    // allocator.
+    inline Arena *&current_arena()
+    {
+        static thread_local Arena *arena = nullptr;
+        return arena;
+    }
+
+    inline Arena &thread_arena()
+    {
+        static thread_local Arena arena;
+        return arena;
+    }
+
+    // While alive, Matrix/Vector heap storage and DynMatrix/DynVector created
+    // on this thread are bump-allocated from arena; on exit everything they
+    // took is released at once. Scopes nest. Objects allocated inside must
+    // not outlive the scope: clone() results out of it after the scope, or
+    // compute them before opening it. Move-assigning a result to an object
+    // whose block comes from elsewhere copies it into that block. The scope
+    // only affects its own thread: pool workers allocate from the global
+    // allocator except inside scopes they open themselves (gemm_parallel
+    // does, per tile, on each worker's thread_arena()).
+    class ArenaScope
+    {
+    public:
+        explicit ArenaScope(Arena &arena = thread_arena()) : arena(arena), previous(current_arena()), start(arena.mark())
+        {
+            current_arena() = &arena;
+        }
+        ArenaScope(const ArenaScope &) = delete;
+        ArenaScope &operator=(const ArenaScope &) = delete;
+        ~ArenaScope()
+        {
+            arena.rewind(start);
+            current_arena() = previous;
+        }
+
+    private:
+        Arena &arena;
+        Arena *previous;
+        Arena::Mark start;
+    };
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
@@ -0,0 +1,373 @@
+#ifndef MUTH_CHOLESKY_H
+#define MUTH_CHOLESKY_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "ThreadPool.h"
+#include "Matrix.h"
+
+// Panel width of the blocked symmetric factorizations.
+#ifndef MUTH_CHOLESKY_NB
+#define MUTH_CHOLESKY_NB 64
+#endif
+
+namespace Muth
+{
+
+    // Both factorizations read only the lower triangle of a row-major n x n
+    // block and overwrite it with L. They run right-looking over NB-wide
+    // panels: factor the diagonal block, solve the panel below it, then
+    // subtract the panel's outer product from the trailing lower triangle.
+    // Every inner loop is a dot product along two rows, so access stays
+    // unit-stride and the trailing update reuses one panel from cache.
+
+    // a = L L^T. Returns false if a is not positive definite.
+    template <typename T>
+    bool cholesky_factor(T *a, size_t n)
+    {
+        const size_t nb = MUTH_CHOLESKY_NB;
+        for (size_t kb = 0; kb < n; kb += nb)
+        {
+            const size_t kend = std::min(kb + nb, n);
+
+            for (size_t j = kb; j < kend; j++)
+            {
+                T *row_j = a + j * n;
+                T d = row_j[j];
+                for (size_t k = kb; k < j; k++)
+                    d -= row_j[k] * row_j[k];
+                if (!(d > T(0)))
+                    return false;
+                row_j[j] = std::sqrt(d);
+                for (size_t i = j + 1; i < kend; i++)
+                {
+                    T *row_i = a + i * n;
+                    T sum = row_i[j];
+                    for (size_t k = kb; k < j; k++)
+                        sum -= row_i[k] * row_j[k];
+                    row_i[j] = sum / row_j[j];
+                }
+            }
+
+            parallel_for(kend, n, (kend - kb) * (kend - kb), parallel_config().eliminate_min, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; i++)
+                {
+                    T *row_i = a + i * n;
+                    for (size_t j = kb; j < kend; j++)
+                    {
+                        const T *row_j = a + j * n;
+                        T sum = row_i[j];
+                        for (size_t k = kb; k < j; k++)
+                            sum -= row_i[k] * row_j[k];
+                        row_i[j] = sum / row_j[j];
+                    }
+                }
+            });
+
+            parallel_for(kend, n, n - kend, parallel_config().eliminate_min, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; i++)
+                {
+                    T *row_i = a + i * n;
+                    for (size_t j = kend; j <= i; j++)
+                    {
+                        const T *row_j = a + j * n;
+                        T sum = T(0);
+                        for (size_t k = kb; k < kend; k++)
+                            sum += row_i[k] * row_j[k];
+                        row_i[j] -= sum;
+                    }
+                }
+            });
+        }
+        return true;
+    }
+
+    // a = L D L^T with unit L below the diagonal and D on it. No pivoting, so
+    // it needs every leading minor to be nonsingular; returns false on a
+    // pivot within n eps of the largest element of the lower triangle.
+    // work must hold n elements.
+    template <typename T>
+    bool ldlt_factor(T *a, size_t n, T *work)
+    {
+        T amax = T(0);
+        for (size_t i = 0; i < n; i++)
+            for (size_t c = 0; c <= i; c++)
+                amax = std::max(amax, T(std::abs(a[i * n + c])));
+
+        const size_t nb = MUTH_CHOLESKY_NB;
+        for (size_t kb = 0; kb < n; kb += nb)
+        {
+            const size_t kend = std::min(kb + nb, n);
+
+            for (size_t j = kb; j < kend; j++)
+            {
+                T *row_j = a + j * n;
+                T d = row_j[j];
+                for (size_t k = kb; k < j; k++)
+                {
+                    work[k] = row_j[k] * a[k * n + k];
+                    d -= row_j[k] * work[k];
+                }
+                if (negligible(d, amax, n))
+                    return false;
+                row_j[j] = d;
+                for (size_t i = j + 1; i < kend; i++)
+                {
+                    T *row_i = a + i * n;
+                    T sum = row_i[j];
+                    for (size_t k = kb; k < j; k++)
+                        sum -= row_i[k] * work[k];
+                    row_i[j] = sum / d;
+                }
+            }
+
+            parallel_for(kend, n, (kend - kb) * (kend - kb), parallel_config().eliminate_min, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; i++)
+                {
+                    T *row_i = a + i * n;
+                    for (size_t j = kb; j < kend; j++)
+                    {
+                        const T *row_j = a + j * n;
+                        T sum = row_i[j];
+                        for (size_t k = kb; k < j; k++)
+                            sum -= row_i[k] * row_j[k] * a[k * n + k];
+                        row_i[j] = sum / row_j[j];
+                    }
+                }
+            });
+
+            parallel_for(kend, n, n - kend, parallel_config().eliminate_min, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; i++)
+                {
+                    T *row_i = a + i * n;
+                    for (size_t j = kend; j <= i; j++)
+                    {
+                        const T *row_j = a + j * n;
+                        T sum = T(0);
+                        for (size_t k = kb; k < kend; k++)
+                            sum += row_i[k] * row_j[k] * a[k * n + k];
+                        row_i[j] -= sum;
+                    }
+                }
+            });
+        }
+        return true;
+    }
+
+    // Solves L y = b in place on x (b already copied there).
+    template <typename T>
+    void lower_solve(const T *l, size_t n, T *x, bool unit)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            const T *row = l + i * n;
+            T sum = x[i];
+            for (size_t k = 0; k < i; k++)
+                sum -= row[k] * x[k];
+            x[i] = unit ? sum : sum / row[i];
+        }
+    }
+
+    // Solves L^T x = y in place, walking L by rows so access stays unit-stride.
+    template <typename T>
+    void lower_transpose_solve(const T *l, size_t n, T *x, bool unit)
+    {
+        for (size_t i = n; i-- > 0;)
+        {
+            const T *row = l + i * n;
+            if (!unit)
+                x[i] /= row[i];
+            const T xi = x[i];
+            for (size_t k = 0; k < i; k++)
+                x[k] -= row[k] * xi;
+        }
+    }
+
+    // Cholesky factorization of a symmetric positive-definite Matrix. Only the
+    // lower triangle of the input is read.
+    template <typename T, size_t n>
+    struct Cholesky
+    {
+    private:
+        Matrix<T, n, n> l;
+
+    public:
+        Cholesky(const Matrix<T, n, n> &mat);
+
+        Matrix<T, n, n> lower() const;
+        T det() const;
+        Vector<T, n> solve(const Vector<T, n> &b) const;
+        template <size_t k>
+        Matrix<T, n, k> solve(const Matrix<T, n, k> &b) const;
+        Matrix<T, n, n> inverse() const;
+    };
+
+    template <typename T, size_t n>
+    Cholesky<T, n>::Cholesky(const Matrix<T, n, n> &mat) : l(mat)
+    {
+        if (!cholesky_factor(l.elements, n))
+            throw MuthExceptionInvalidOperation("matrix is not positive definite");
+    }
+
+    template <typename T, size_t n>
+    Matrix<T, n, n> Cholesky<T, n>::lower() const
+    {
+        Matrix<T, n, n> result;
+        for (size_t r = 0; r < n; r++)
+            for (size_t c = 0; c <= r; c++)
+                result[r][c] = l[r][c];
+        return result;
+    }
+
+    template <typename T, size_t n>
+    T Cholesky<T, n>::det() const
+    {
+        T ans = T(1);
+        for (size_t i = 0; i < n; i++)
+            ans *= l[i][i];
+        return ans * ans;
+    }
+
+    template <typename T, size_t n>
+    Vector<T, n> Cholesky<T, n>::solve(const Vector<T, n> &b) const
+    {
+        Vector<T, n> x(b);
+        lower_solve(l.elements, n, x.elements, false);
+        lower_transpose_solve(l.elements, n, x.elements, false);
+        return x;
+    }
+
+    template <typename T, size_t n>
+    template <size_t k>
+    Matrix<T, n, k> Cholesky<T, n>::solve(const Matrix<T, n, k> &b) const
+    {
+        Matrix<T, n, k> x;
+        std::array<T, n> column;
+        for (size_t c = 0; c < k; c++)
+        {
+            for (size_t r = 0; r < n; r++)
+                column[r] = b[r][c];
+            lower_solve(l.elements, n, column.data(), false);
+            lower_transpose_solve(l.elements, n, column.data(), false);
+            for (size_t r = 0; r < n; r++)
+                x[r][c] = column[r];
+        }
+        return x;
+    }
+
+    template <typename T, size_t n>
+    Matrix<T, n, n> Cholesky<T, n>::inverse() const
+    {
+        Matrix<T, n, n> identity;
+        for (size_t i = 0; i < n; i++)
+            identity[i][i] = T(1);
+        return solve(identity);
+    }
+
+    // L D L^T factorization of a symmetric Matrix with nonsingular leading
+    // minors (e.g. quasi-definite systems). Avoids square roots. Only the
+    // lower triangle of the input is read.
+    template <typename T, size_t n>
+    struct LDLT
+    {
+    private:
+        Matrix<T, n, n> ld;
+
+    public:
+        LDLT(const Matrix<T, n, n> &mat);
+
+        Matrix<T, n, n> lower() const;
+        Vector<T, n> diagonal() const;
+        T det() const;
+        Vector<T, n> solve(const Vector<T, n> &b) const;
+        template <size_t k>
+        Matrix<T, n, k> solve(const Matrix<T, n, k> &b) const;
+        Matrix<T, n, n> inverse() const;
+    };
+
+    template <typename T, size_t n>
+    LDLT<T, n>::LDLT(const Matrix<T, n, n> &mat) : ld(mat)
+    {
+        std::array<T, n> work;
+        if (!ldlt_factor(ld.elements, n, work.data()))
+            throw MuthExceptionInvalidOperation("matrix has a singular leading minor");
+    }
+
+    template <typename T, size_t n>
+    Matrix<T, n, n> LDLT<T, n>::lower() const
+    {
+        Matrix<T, n, n> result;
+        for (size_t r = 0; r < n; r++)
+        {
+            for (size_t c = 0; c < r; c++)
+                result[r][c] = ld[r][c];
+            result[r][r] = T(1);
+        }
+        return result;
+    }
+
+    template <typename T, size_t n>
+    Vector<T, n> LDLT<T, n>::diagonal() const
+    {
+        Vector<T, n> d;
+        for (size_t i = 0; i < n; i++)
+            d[i] = ld[i][i];
+        return d;
+    }
+
+    template <typename T, size_t n>
+    T LDLT<T, n>::det() const
+    {
+        T ans = T(1);
+        for (size_t i = 0; i < n; i++)
+            ans *= ld[i][i];
+        return ans;
+    }
+
+    template <typename T, size_t n>
+    Vector<T, n> LDLT<T, n>::solve(const Vector<T, n> &b) const
+    {
+        Vector<T, n> x(b);
+        lower_solve(ld.elements, n, x.elements, true);
+        for (size_t i = 0; i < n; i++)
+            x[i] /= ld[i][i];
+        lower_transpose_solve(ld.elements, n, x.elements, true);
+        return x;
+    }
+
+    template <typename T, size_t n>
+    template <size_t k>
+    Matrix<T, n, k> LDLT<T, n>::solve(const Matrix<T, n, k> &b) const
+    {
+        Matrix<T, n, k> x;
+        std::array<T, n> column;
+        for (size_t c = 0; c < k; c++)
+        {
+            for (size_t r = 0; r < n; r++)
+                column[r] = b[r][c];
+            lower_solve(ld.elements, n, column.data(), true);
+            for (size_t r = 0; r < n; r++)
+                column[r] /= ld[r][r];
+            lower_transpose_solve(ld.elements, n, column.data(), true);
+            for (size_t r = 0; r < n; r++)
+                x[r][c] = column[r];
+        }
+        return x;
+    }
+
+    template <typename T, size_t n>
+    Matrix<T, n, n> LDLT<T, n>::inverse() const
+    {
+        Matrix<T, n, n> identity;
+        for (size_t i = 0; i < n; i++)
+            identity[i][i] = T(1);
+        return solve(identity);
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
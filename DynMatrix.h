@@ -0,0 +1,395 @@
+#ifndef MUTH_DYN_MATRIX_H
+#define MUTH_DYN_MATRIX_H
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "Storage.h"
+#include "Gemm.h"
+#include "Transpose.h"
+#include "Matrix.h"
+#include "DynVector.h"
+
+namespace Muth
+{
+
+    // Matrix whose shape is chosen at runtime, stored row-major in one
+    // contiguous aligned block. Same operations as Matrix; move-only, use
+    // clone() for a deep copy.
+    template <typename T>
+    struct DynMatrix : public DynStorage<T>
+    {
+    public:
+        using Storage = DynStorage<T>;
+        using Storage::elements;
+
+    private:
+        size_t n;
+        size_t m;
+
+    public:
+        DynMatrix() : n(0), m(0) {}
+        DynMatrix(size_t rows, size_t cols) : Storage(rows * cols), n(rows), m(cols) {}
+        DynMatrix(size_t rows, size_t cols, const T *values);
+        DynMatrix(size_t rows, size_t cols, const std::initializer_list<T> &values);
+        template <size_t rows, size_t cols>
+        DynMatrix(const Matrix<T, rows, cols> &mat) : DynMatrix(rows, cols, mat.elements) {}
+        DynMatrix(DynMatrix<T> &&r_value) noexcept;
+        DynMatrix<T> &operator=(DynMatrix<T> &&other);
+
+        DynMatrix<T> clone() const { return DynMatrix<T>(n, m, elements); }
+
+        DynMatrix<T> &operator+=(const DynMatrix<T> &other);
+        DynMatrix<T> &operator-=(const DynMatrix<T> &other);
+        DynMatrix<T> &operator*=(T lambda);
+        DynMatrix<T> &operator/=(T lambda);
+
+        size_t rows() const { return n; }
+        size_t cols() const { return m; }
+
+        inline T *operator[](const size_t &row) { return elements + row * m; }
+        inline const T *operator[](const size_t &row) const { return elements + row * m; }
+        inline T &get_ref(const size_t &row, const size_t &col);
+        inline const T &get_ref(const size_t &row, const size_t &col) const;
+
+        std::string to_string(const std::string &separator = " ", const std::string &end_row = "") const;
+        operator std::string() const { return this->to_string(); }
+
+        operator T *() { return elements; }
+        operator const T *() const { return elements; }
+
+        inline DynMatrix<T> transform() const;
+        // Square matrices are transposed without a second buffer.
+        void transform_in_place();
+
+        inline void row_multiply(const size_t &r, const T &k);
+        inline void row_swap(const size_t &r1, const size_t &r2);
+        inline void row_add_to(const size_t &added_r, const size_t &add_r, T k);
+
+        void gaussian_eliminate();
+        T det() const;
+
+        bool reversible() const;
+    };
+
+    inline void dyn_check_shape(size_t left_rows, size_t left_cols, size_t right_rows, size_t right_cols)
+    {
+        if (left_rows != right_rows || left_cols != right_cols)
+            throw MuthExceptionInvalidOperation("matrix shapes do not match");
+    }
+
+    template <typename T>
+    DynMatrix<T>::DynMatrix(size_t rows, size_t cols, const T *values) : Storage(rows * cols), n(rows), m(cols)
+    {
+        std::copy_n(values, n * m, elements);
+    }
+
+    template <typename T>
+    DynMatrix<T>::DynMatrix(size_t rows, size_t cols, const std::initializer_list<T> &values) : Storage(rows * cols), n(rows), m(cols)
+    {
+        std::copy_n(values.begin(), std::min(values.size(), n * m), elements);
+    }
+
+    template <typename T>
+    DynMatrix<T>::DynMatrix(DynMatrix<T> &&r_value) noexcept : Storage(std::move(r_value)), n(r_value.n), m(r_value.m)
+    {
+        r_value.n = 0;
+        r_value.m = 0;
+    }
+
+    template <typename T>
+    DynMatrix<T> &DynMatrix<T>::operator=(DynMatrix<T> &&other)
+    {
+        Storage::operator=(std::move(other));
+        n = other.n;
+        m = other.m;
+        other.n = 0;
+        other.m = 0;
+        return *this;
+    }
+
+    template <typename T>
+    inline DynMatrix<T> &DynMatrix<T>::operator+=(const DynMatrix<T> &other)
+    {
+        dyn_check_shape(n, m, other.n, other.m);
+        for (size_t i = 0; i < n * m; i++)
+            elements[i] += other.elements[i];
+        return *this;
+    }
+
+    template <typename T>
+    inline DynMatrix<T> &DynMatrix<T>::operator-=(const DynMatrix<T> &other)
+    {
+        dyn_check_shape(n, m, other.n, other.m);
+        for (size_t i = 0; i < n * m; i++)
+            elements[i] -= other.elements[i];
+        return *this;
+    }
+
+    template <typename T>
+    inline DynMatrix<T> &DynMatrix<T>::operator*=(T lambda)
+    {
+        for (size_t i = 0; i < n * m; i++)
+            elements[i] *= lambda;
+        return *this;
+    }
+
+    template <typename T>
+    inline DynMatrix<T> &DynMatrix<T>::operator/=(T lambda)
+    {
+        for (size_t i = 0; i < n * m; i++)
+            elements[i] /= lambda;
+        return *this;
+    }
+
+    template <typename T>
+    inline T &DynMatrix<T>::get_ref(const size_t &row, const size_t &col)
+    {
+        if (row < n && col < m)
+            return elements[row * m + col];
+        else
+            throw MuthOutOfRangeException("matrix index out of range");
+    }
+
+    template <typename T>
+    inline const T &DynMatrix<T>::get_ref(const size_t &row, const size_t &col) const
+    {
+        if (row < n && col < m)
+            return elements[row * m + col];
+        else
+            throw MuthOutOfRangeException("matrix index out of range");
+    }
+
+    template <typename T>
+    std::string DynMatrix<T>::to_string(const std::string &separator /*= " "*/, const std::string &end_row /*= ""*/) const
+    {
+        std::stringstream ss;
+        for (size_t r = 0; r < n; r++)
+        {
+            for (size_t c = 0; c < m; c++)
+            {
+                ss << elements[r * m + c] << separator;
+            }
+            ss << end_row;
+        }
+        return ss.str();
+    }
+
+    template <typename T>
+    inline DynMatrix<T> DynMatrix<T>::transform() const
+    {
+        DynMatrix<T> t(m, n);
+        transpose(n, m, elements, m, t.elements, n);
+        return t;
+    }
+
+    template <typename T>
+    void DynMatrix<T>::transform_in_place()
+    {
+        if (n == m)
+            transpose_in_place(n, elements, n);
+        else
+            *this = transform();
+    }
+
+    template <typename T>
+    inline void DynMatrix<T>::row_multiply(const size_t &r, const T &k)
+    {
+        T *row = elements + r * m;
+        for (size_t i = 0; i < m; i++)
+            row[i] *= k;
+    }
+
+    template <typename T>
+    inline void DynMatrix<T>::row_swap(const size_t &r1, const size_t &r2)
+    {
+        std::swap_ranges(elements + r1 * m, elements + r1 * m + m, elements + r2 * m);
+    }
+
+    template <typename T>
+    inline void DynMatrix<T>::row_add_to(const size_t &added_r, const size_t &add_r, T k)
+    {
+        T *added = elements + added_r * m;
+        const T *add = elements + add_r * m;
+        for (size_t i = 0; i < m; i++)
+            added[i] += add[i] * k;
+    }
+
+    template <typename T>
+    void DynMatrix<T>::gaussian_eliminate()
+    {
+        T amax = T(0);
+        for (size_t i = 0; i < n * m; i++)
+            amax = std::max(amax, T(std::abs(elements[i])));
+        for (size_t i = 0; i < m && i < n; i++)
+        {
+            size_t nonzero = i;
+            for (nonzero = i; nonzero < n; nonzero++)
+                if (!negligible(elements[nonzero * m + i], amax, std::max(n, m)))
+                    break;
+            if (nonzero >= n)
+                continue;
+            if (nonzero != i)
+                row_swap(i, nonzero);
+            parallel_for(i + 1, n, m, parallel_config().eliminate_min, [&](size_t lo, size_t hi) {
+                for (size_t r = lo; r < hi; r++)
+                    row_add_to(r, i, -elements[r * m + i] / elements[i * m + i]);
+            });
+        }
+    }
+
+    template <typename T>
+    T DynMatrix<T>::det() const
+    {
+        if (n != m)
+            throw MuthExceptionInvalidOperation("trying to calculate determinant of a non-square matrix");
+        if (n == 0)
+            return T(1);
+
+        DynMatrix<T> tmp = clone();
+        tmp.gaussian_eliminate();
+        T ans = tmp[0][0];
+        for (size_t i = 1; i < n; i++)
+            ans *= tmp[i][i];
+        return ans;
+    }
+
+    template <typename T>
+    inline bool DynMatrix<T>::reversible() const
+    {
+        if (n != m)
+            return false;
+
+        T amax = T(0);
+        for (size_t i = 0; i < n * m; i++)
+            amax = std::max(amax, T(std::abs(elements[i])));
+        DynMatrix<T> tmp = clone();
+        tmp.gaussian_eliminate();
+        for (size_t i = 0; i < n; i++)
+            if (negligible(tmp[i][i], amax, n))
+                return false;
+        return true;
+    }
+
+    template <typename T>
+    std::ostream &operator<<(std::ostream &out, const DynMatrix<T> &mat)
+    {
+        return out << mat.to_string();
+    }
+
+    template <typename T>
+    DynMatrix<T> operator-(const DynMatrix<T> &mat)
+    {
+        DynMatrix<T> result = mat.clone();
+        result *= T(-1);
+        return result;
+    }
+
+    template <typename T>
+    DynMatrix<T> operator*(const DynMatrix<T> &left, const DynMatrix<T> &right)
+    {
+        if (left.cols() != right.rows())
+            throw MuthExceptionInvalidOperation("matrix shapes do not match");
+        DynMatrix<T> result(left.rows(), right.cols());
+        gemm(left.rows(), left.cols(), right.cols(), left.elements, left.cols(), right.elements, right.cols(), result.elements, right.cols());
+        return result;
+    }
+
+    template <typename T>
+    DynMatrix<T> operator*(const DynMatrix<T> &mat, T lambda)
+    {
+        DynMatrix<T> result = mat.clone();
+        result *= lambda;
+        return result;
+    }
+
+    template <typename T>
+    DynMatrix<T> operator/(const DynMatrix<T> &mat, T lambda)
+    {
+        DynMatrix<T> result = mat.clone();
+        result /= lambda;
+        return result;
+    }
+
+    template <typename T>
+    DynMatrix<T> operator*(T lambda, const DynMatrix<T> &mat)
+    {
+        return mat * lambda;
+    }
+
+    template <typename T>
+    DynVector<T> operator*(const DynMatrix<T> &mat, const DynVector<T> &vec)
+    {
+        if (mat.cols() != vec.size())
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        DynVector<T> result(mat.rows());
+        for (size_t r = 0; r < mat.rows(); r++)
+        {
+            const T *row = mat[r];
+            accumulator_t<T> sum = accumulator_t<T>();
+            for (size_t c = 0; c < mat.cols(); c++)
+                sum += accumulator_t<T>(row[c]) * accumulator_t<T>(vec[c]);
+            result[r] = T(sum);
+        }
+        return result;
+    }
+
+    template <typename T>
+    DynVector<T> operator*(const DynVector<T> &vec, const DynMatrix<T> &mat)
+    {
+        if (mat.rows() != vec.size())
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        DynVector<T> result(mat.cols());
+        if constexpr (!std::is_same<accumulator_t<T>, T>::value)
+        {
+            std::vector<accumulator_t<T>> sums(mat.cols());
+            gemm_accumulate(size_t(1), mat.rows(), mat.cols(), vec.elements, vec.size(), mat.elements, mat.cols(), sums.data(), mat.cols());
+            for (size_t c = 0; c < mat.cols(); c++)
+                result[c] = T(sums[c]);
+            return result;
+        }
+        for (size_t r = 0; r < mat.rows(); r++)
+        {
+            const T *row = mat[r];
+            const T k = vec[r];
+            for (size_t c = 0; c < mat.cols(); c++)
+                result[c] += row[c] * k;
+        }
+        return result;
+    }
+
+    template <typename T>
+    DynMatrix<T> operator+(const DynMatrix<T> &left, const DynMatrix<T> &right)
+    {
+        DynMatrix<T> result = left.clone();
+        result += right;
+        return result;
+    }
+
+    template <typename T>
+    DynMatrix<T> operator-(const DynMatrix<T> &left, const DynMatrix<T> &right)
+    {
+        DynMatrix<T> result = left.clone();
+        result -= right;
+        return result;
+    }
+
+    template <typename T>
+    bool operator==(const DynMatrix<T> &left, const DynMatrix<T> &right)
+    {
+        if (left.rows() != right.rows() || left.cols() != right.cols())
+            return false;
+        for (size_t i = 0; i < left.rows() * left.cols(); i++)
+            if (!equal(left.elements[i], right.elements[i]))
+                return false;
+        return true;
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
@@ -0,0 +1,237 @@
+#ifndef MUTH_DYN_VECTOR_H
+#define MUTH_DYN_VECTOR_H
+
+#include <cmath>
+#include <string>
+#include <sstream>
+#include "MuthException.h"
+#include "Storage.h"
+#include "Vector.h"
+
+namespace Muth
+{
+    // Vector whose length is chosen at runtime. Same operations as Vector;
+    // move-only, use clone() for a deep copy.
+    template <typename T>
+    struct DynVector : public DynStorage<T>
+    {
+        using Storage = DynStorage<T>;
+        using Storage::elements;
+
+    private:
+        size_t length_;
+
+    public:
+        DynVector() : length_(0) {}
+        explicit DynVector(size_t n) : Storage(n), length_(n) {}
+        DynVector(size_t n, const T *values);
+        DynVector(const std::initializer_list<T> &values);
+        template <size_t n>
+        DynVector(const Vector<T, n> &vec) : DynVector(n, vec.elements) {}
+        DynVector(DynVector<T> &&r_value) noexcept : Storage(std::move(r_value)), length_(r_value.length_) { r_value.length_ = 0; }
+        DynVector<T> &operator= (DynVector<T> &&other)
+        {
+            Storage::operator=(std::move(other));
+            length_ = other.length_;
+            other.length_ = 0;
+            return *this;
+        }
+
+        DynVector<T> clone() const { return DynVector<T>(length_, elements); }
+
+    public:
+        size_t size() const { return length_; }
+
+        T& operator[] (const size_t &idx) { return elements[idx]; }
+        const T& operator[] (const size_t &idx) const { return elements[idx]; }
+
+        std::string to_string(const std::string &separator = " ") const;
+
+    public:
+        template <typename Acc = accumulator_t<T>>
+        Acc length_square() const;
+        T length() const;
+        DynVector<T> normalized() const;
+        T projection(const DynVector<T> &vec) const;
+        DynVector<T> projection_vector(const DynVector<T> &vec) const;
+        template <typename Acc = accumulator_t<T>>
+        Acc dot(const DynVector<T> &other) const;
+
+    public:
+        DynVector<T> &operator+= (const DynVector<T> &other);
+        DynVector<T> &operator-= (const DynVector<T> &other);
+        DynVector<T> &operator*= (T lambda);
+        DynVector<T> &operator/= (T lambda);
+    };
+
+    inline void dyn_check_size(size_t left, size_t right)
+    {
+        if (left != right)
+            throw MuthExceptionInvalidOperation("vector sizes do not match");
+    }
+
+    template <typename T>
+    inline DynVector<T>::DynVector(size_t n, const T *values) : Storage(n), length_(n)
+    {
+        std::copy_n(values, n, elements);
+    }
+
+    template <typename T>
+    inline DynVector<T>::DynVector(const std::initializer_list<T> &values) : Storage(values.size()), length_(values.size())
+    {
+        std::copy(values.begin(), values.end(), elements);
+    }
+
+    template <typename T>
+    inline std::string DynVector<T>::to_string(const std::string &separator /*= " "*/) const
+    {
+        std::stringstream ss;
+        for (size_t i = 0; i < length_; i++)
+            ss << elements[i] << separator;
+        return ss.str();
+    }
+
+    template <typename T>
+    template <typename Acc>
+    inline Acc DynVector<T>::length_square() const
+    {
+        return this->template dot<Acc>(*this);
+    }
+
+    template <typename T>
+    inline T DynVector<T>::length() const
+    {
+        return T(std::sqrt(this->length_square()));
+    }
+
+    template <typename T>
+    inline DynVector<T> DynVector<T>::normalized() const
+    {
+        DynVector<T> result(length_);
+        T len = this->length();
+        for (size_t i = 0; i < length_; i++)
+            result[i] = elements[i] / len;
+        return result;
+    }
+
+    template <typename T>
+    inline T DynVector<T>::projection(const DynVector<T> &vec) const
+    {
+        return T(this->dot(vec) / vec.length());
+    }
+
+    template <typename T>
+    inline DynVector<T> DynVector<T>::projection_vector(const DynVector<T> &vec) const
+    {
+        DynVector<T> result = vec.normalized();
+        result *= this->projection(vec);
+        return result;
+    }
+
+    // Products are widened to Acc before they are summed.
+    template <typename T>
+    template <typename Acc>
+    inline Acc DynVector<T>::dot(const DynVector<T> &other) const
+    {
+        dyn_check_size(length_, other.length_);
+        Acc result = (Acc)0;
+        for (size_t i = 0; i < length_; i++)
+            result += Acc(elements[i]) * Acc(other.elements[i]);
+        return result;
+    }
+
+    template <typename T>
+    inline DynVector<T> &DynVector<T>::operator+=(const DynVector<T> &other)
+    {
+        dyn_check_size(length_, other.length_);
+        for (size_t i = 0; i < length_; i++)
+            elements[i] += other.elements[i];
+        return *this;
+    }
+
+    template <typename T>
+    inline DynVector<T> &DynVector<T>::operator-=(const DynVector<T> &other)
+    {
+        dyn_check_size(length_, other.length_);
+        for (size_t i = 0; i < length_; i++)
+            elements[i] -= other.elements[i];
+        return *this;
+    }
+
+    template <typename T>
+    inline DynVector<T> &DynVector<T>::operator*=(T lambda)
+    {
+        for (size_t i = 0; i < length_; i++)
+            elements[i] *= lambda;
+        return *this;
+    }
+
+    template <typename T>
+    inline DynVector<T> &DynVector<T>::operator/=(T lambda)
+    {
+        for (size_t i = 0; i < length_; i++)
+            elements[i] /= lambda;
+        return *this;
+    }
+
+    template <typename T>
+    inline DynVector<T> operator+(const DynVector<T> &left, const DynVector<T> &right)
+    {
+        DynVector<T> result = left.clone();
+        result += right;
+        return result;
+    }
+
+    template <typename T>
+    inline DynVector<T> operator-(const DynVector<T> &left, const DynVector<T> &right)
+    {
+        DynVector<T> result = left.clone();
+        result -= right;
+        return result;
+    }
+
+    template <typename T>
+    inline DynVector<T> operator*(const DynVector<T> &vec, T lambda)
+    {
+        DynVector<T> result = vec.clone();
+        result *= lambda;
+        return result;
+    }
+
+    template <typename T>
+    inline DynVector<T> operator*(T lambda, const DynVector<T> &vec)
+    {
+        return vec * lambda;
+    }
+
+    template <typename T>
+    inline DynVector<T> operator/(const DynVector<T> &vec, T lambda)
+    {
+        DynVector<T> result = vec.clone();
+        result /= lambda;
+        return result;
+    }
+
+    template <typename T>
+    inline accumulator_t<T> operator*(const DynVector<T> &left, const DynVector<T> &right)
+    {
+        return left.dot(right);
+    }
+
+    template <typename T>
+    inline DynVector<T> operator-(const DynVector<T> &vec)
+    {
+        DynVector<T> result(vec.size());
+        for (size_t i = 0; i < vec.size(); i++)
+            result[i] = -vec[i];
+        return result;
+    }
+
+    template <typename T>
+    inline std::ostream &operator<<(std::ostream &out, const DynVector<T> &vec)
+    {
+        return out << vec.to_string();
+    }
+} // namespace Muth
+
+#endif
\ No newline at end of file
@@ -0,0 +1,1108 @@
+#ifndef MUTH_EIGEN_H
+#define MUTH_EIGEN_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "Matrix.h"
+#include "Vec3.h"
+#include "DynMatrix.h"
+#include "View.h"
+#include "Transpose.h"
+
+// Implicit QR steps allowed per eigenvalue (or singular value) before the
+// iteration gives up.
+#ifndef MUTH_EIGEN_MAX_ITERATIONS
+#define MUTH_EIGEN_MAX_ITERATIONS 30
+#endif
+
+namespace Muth
+{
+
+    // Symmetric eigenproblems go through a Householder reduction to
+    // tridiagonal form and implicit Wilkinson-shifted QR on the tridiagonal,
+    // the same route as LAPACK's dsyev. The SVD is the Golub-Kahan analogue
+    // (dgesvd): Householder reduction to bidiagonal form from both sides,
+    // then shifted QR on the bidiagonal. Rotations are always applied to rows
+    // of row-major blocks: eigenvectors and singular vectors are accumulated
+    // transposed and turned around at the end.
+
+    // Scratch elements sym_eigen needs for an n x n matrix.
+    constexpr size_t sym_eigen_work_size(size_t n)
+    {
+        return 4 * n;
+    }
+
+    // Scratch elements svd_factor needs for an n x m matrix with n >= m.
+    constexpr size_t svd_work_size(size_t n, size_t m)
+    {
+        return n + 4 * m + m * n + m * m;
+    }
+
+    // Dot product split over four sums, so the additions do not wait on each
+    // other.
+    template <typename T>
+    inline T eigen_dot(const T *a, const T *b, size_t len)
+    {
+        T s0 = T(0), s1 = T(0), s2 = T(0), s3 = T(0);
+        size_t i = 0;
+        for (; i + 4 <= len; i += 4)
+        {
+            s0 += a[i] * b[i];
+            s1 += a[i + 1] * b[i + 1];
+            s2 += a[i + 2] * b[i + 2];
+            s3 += a[i + 3] * b[i + 3];
+        }
+        for (; i < len; i++)
+            s0 += a[i] * b[i];
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    // sqrt(x^2 + y^2), falling back to std::hypot (several times slower) only
+    // when the squares overflow or underflow.
+    template <typename T>
+    inline T eigen_hypot(T x, T y)
+    {
+        const T r = std::sqrt(x * x + y * y);
+        if (r < std::numeric_limits<T>::max() && r > std::sqrt(std::numeric_limits<T>::min()))
+            return r;
+        return std::hypot(x, y);
+    }
+
+    // Power of two that brings amax to [0.5, 1). The drivers scale their input
+    // by it, exactly, so that the squares taken by reflectors and shifts
+    // cannot overflow or underflow.
+    template <typename T>
+    inline T eigen_scale(T amax)
+    {
+        if (!(amax > T(0)) || !std::isfinite(amax))
+            return T(1);
+        int exponent;
+        std::frexp(amax, &exponent);
+        return std::ldexp(T(1), -exponent);
+    }
+
+    // Givens rotation with c x + s z = r and c z - s x = 0; returns r.
+    template <typename T>
+    inline T eigen_givens(T x, T z, T &c, T &s)
+    {
+        const T r = eigen_hypot(x, z);
+        if (r == T(0))
+        {
+            c = T(1);
+            s = T(0);
+            return r;
+        }
+        const T inv = T(1) / r;
+        c = x * inv;
+        s = z * inv;
+        return r;
+    }
+
+    // (x, y) <- (c x + s y, c y - s x) over len elements.
+    template <typename T>
+    inline void eigen_rotate(T *x, T *y, size_t len, T c, T s)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            const T xi = x[i], yi = y[i];
+            x[i] = c * xi + s * yi;
+            y[i] = c * yi - s * xi;
+        }
+    }
+
+    // Householder reflector H = I - tau v v^T with H x = (beta, 0, ..., 0).
+    // x is overwritten with v, v[0] = 1; returns beta.
+    template <typename T>
+    T eigen_reflector(T *x, size_t len, T &tau)
+    {
+        const T alpha = x[0];
+        T xnorm_sq = T(0);
+        for (size_t i = 1; i < len; i++)
+            xnorm_sq += x[i] * x[i];
+        x[0] = T(1);
+        if (xnorm_sq == T(0))
+        {
+            tau = T(0);
+            return alpha;
+        }
+        const T norm = std::sqrt(alpha * alpha + xnorm_sq);
+        const T beta = alpha >= T(0) ? -norm : norm;
+        tau = (beta - alpha) / beta;
+        const T scale = T(1) / (alpha - beta);
+        for (size_t i = 1; i < len; i++)
+            x[i] *= scale;
+        return beta;
+    }
+
+    // Reduces the symmetric row-major n x n block a to tridiagonal form
+    // Q^T a Q, with diagonal d (n) and off-diagonal e (n - 1). Only the lower
+    // triangle is read. Reflector j is kept in row j from column j + 1 on,
+    // with tau[j]; tau[n - 2] is zero. Each step applies the rank-2 update
+    // A -= v w^T + w v^T to the trailing rows and, in the same pass, sums
+    // those rows into A v for the next reflector, so the trailing block is
+    // read once per step. w needs 2n elements.
+    template <typename T>
+    void sym_tridiagonalize(T *a, size_t n, T *d, T *e, T *tau, T *w)
+    {
+        if (n == 0)
+            return;
+        for (size_t r = 1; r < n; r++)
+            for (size_t c = 0; c < r; c++)
+                a[c * n + r] = a[r * n + c];
+
+        T *p = w + n;
+        if (n > 2)
+        {
+            e[0] = eigen_reflector(a + 1, n - 1, tau[0]);
+            std::fill(p + 1, p + n, T(0));
+            for (size_t i = 1; i < n; i++)
+            {
+                const T vi = a[i];
+                const T *row = a + i * n;
+                for (size_t c = 1; c < n; c++)
+                    p[c] += vi * row[c];
+            }
+        }
+        for (size_t j = 0; j + 2 < n; j++)
+        {
+            d[j] = a[j * n + j];
+            const T *v = a + j * n;
+            const T t = tau[j];
+
+            // w = tau p - (tau / 2) (tau p . v) v
+            T k = T(0);
+            for (size_t c = j + 1; c < n; c++)
+            {
+                w[c] = t * p[c];
+                k += w[c] * v[c];
+            }
+            k *= t / T(2);
+            for (size_t c = j + 1; c < n; c++)
+                w[c] -= k * v[c];
+
+            T *next = a + (j + 1) * n;
+            for (size_t c = j + 1; c < n; c++)
+                next[c] -= v[j + 1] * w[c] + w[j + 1] * v[c];
+            const bool more = j + 3 < n;
+            if (more)
+            {
+                e[j + 1] = eigen_reflector(next + j + 2, n - j - 2, tau[j + 1]);
+                std::fill(p + j + 2, p + n, T(0));
+            }
+            for (size_t i = j + 2; i < n; i++)
+            {
+                T *row = a + i * n;
+                const T vi = v[i], wi = w[i];
+                for (size_t c = j + 2; c < n; c++)
+                    row[c] -= vi * w[c] + wi * v[c];
+                if (more)
+                {
+                    const T ui = next[i];
+                    for (size_t c = j + 2; c < n; c++)
+                        p[c] += ui * row[c];
+                }
+            }
+        }
+        if (n >= 2)
+        {
+            d[n - 2] = a[(n - 2) * n + n - 2];
+            e[n - 2] = a[(n - 2) * n + n - 1];
+            tau[n - 2] = T(0);
+        }
+        d[n - 1] = a[(n - 1) * n + n - 1];
+    }
+
+    // Overwrites sym_tridiagonalize output with Q = H_0 H_1 ... H_{n-3},
+    // accumulating from the last reflector back so each one only touches the
+    // trailing block it acts on. w needs n elements.
+    template <typename T>
+    void sym_tridiagonal_q(T *a, size_t n, const T *tau, T *w)
+    {
+        for (size_t b = n; b-- > 0;)
+        {
+            a[b * n + b] = T(1);
+            for (size_t c = b + 1; c < n; c++)
+            {
+                a[b * n + c] = T(0);
+                a[c * n + b] = T(0);
+            }
+            if (b == 0 || tau[b - 1] == T(0))
+                continue;
+
+            // rows b .. n-1 of the block: Y -= tau v (v^T Y)
+            const T *v = a + (b - 1) * n;
+            const T t = tau[b - 1];
+            std::fill(w + b, w + n, T(0));
+            for (size_t r = b; r < n; r++)
+            {
+                const T vr = v[r];
+                const T *row = a + r * n;
+                for (size_t c = b; c < n; c++)
+                    w[c] += vr * row[c];
+            }
+            for (size_t r = b; r < n; r++)
+            {
+                const T vr = t * v[r];
+                T *row = a + r * n;
+                for (size_t c = b; c < n; c++)
+                    row[c] -= vr * w[c];
+            }
+        }
+    }
+
+    // One implicit QR step with Wilkinson shift on the unreduced block
+    // [start, end] of the tridiagonal (d, e), chasing the bulge down with
+    // Givens rotations. Rows start .. end of qt (n columns) receive the same
+    // rotations when qt is not null.
+    template <typename T>
+    void sym_tridiagonal_qr_step(T *d, T *e, size_t start, size_t end, T *qt, size_t n)
+    {
+        const T td = (d[end - 1] - d[end]) / T(2);
+        const T last = e[end - 1];
+        T mu = d[end];
+        if (td == T(0))
+            mu -= std::abs(last);
+        else
+        {
+            const T h = eigen_hypot(td, last);
+            mu -= last * (last / (td + (td > T(0) ? h : -h)));
+        }
+
+        T x = d[start] - mu;
+        T z = e[start];
+        for (size_t k = start; k < end; k++)
+        {
+            T c, s;
+            const T r = eigen_givens(x, z, c, s);
+            if (k > start)
+                e[k - 1] = r;
+
+            const T dk = d[k], ek = e[k], dk1 = d[k + 1];
+            const T cc = c * c, ss = s * s, cs = c * s;
+            d[k] = cc * dk + T(2) * cs * ek + ss * dk1;
+            d[k + 1] = ss * dk - T(2) * cs * ek + cc * dk1;
+            e[k] = cs * (dk1 - dk) + (cc - ss) * ek;
+            if (k + 1 < end)
+            {
+                z = s * e[k + 1];
+                e[k + 1] *= c;
+            }
+            x = e[k];
+            if (qt)
+                eigen_rotate(qt + k * n, qt + (k + 1) * n, n, c, s);
+        }
+    }
+
+    // Eigenvalues of the symmetric tridiagonal (d, e) into d; rotations are
+    // applied to the rows of qt (n x n) when it is not null.
+    template <typename T>
+    void sym_tridiagonal_qr(T *d, T *e, size_t n, T *qt)
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        const T tiny = std::numeric_limits<T>::min();
+        const size_t max_iterations = MUTH_EIGEN_MAX_ITERATIONS * n;
+        size_t iterations = 0;
+        size_t end = n ? n - 1 : 0;
+        while (end > 0)
+        {
+            for (size_t i = 0; i < end; i++)
+                if (std::abs(e[i]) <= eps * (std::abs(d[i]) + std::abs(d[i + 1])) || std::abs(e[i]) < tiny)
+                    e[i] = T(0);
+            while (end > 0 && e[end - 1] == T(0))
+                end--;
+            if (end == 0)
+                break;
+            if (++iterations > max_iterations)
+                throw MuthExceptionInvalidOperation("eigenvalue iteration did not converge");
+            size_t start = end - 1;
+            while (start > 0 && e[start - 1] != T(0))
+                start--;
+            sym_tridiagonal_qr_step(d, e, start, end, qt, n);
+        }
+    }
+
+    // Sorts d ascending, moving the matching rows of qt (n x n) along.
+    template <typename T>
+    void sym_eigen_sort(T *d, size_t n, T *qt)
+    {
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            size_t least = i;
+            for (size_t j = i + 1; j < n; j++)
+                if (d[j] < d[least])
+                    least = j;
+            if (least == i)
+                continue;
+            std::swap(d[i], d[least]);
+            if (qt)
+                std::swap_ranges(qt + i * n, qt + i * n + n, qt + least * n);
+        }
+    }
+
+    // Eigenvalues of the symmetric row-major n x n block a, ascending, into
+    // values. Only the lower triangle is read. With vectors set, a is
+    // overwritten with the orthonormal eigenvectors as columns, in the same
+    // order; otherwise its contents are unspecified. work needs
+    // sym_eigen_work_size(n) elements.
+    template <typename T>
+    void sym_eigen(T *a, size_t n, T *values, bool vectors, T *work)
+    {
+        if (n == 0)
+            return;
+        T *e = work;
+        T *tau = work + n;
+        T *w = work + 2 * n;
+        T amax = T(0);
+        for (size_t r = 0; r < n; r++)
+            for (size_t c = 0; c <= r; c++)
+                amax = std::max(amax, std::abs(a[r * n + c]));
+        const T scale = eigen_scale(amax);
+        for (size_t r = 0; r < n; r++)
+            for (size_t c = 0; c <= r; c++)
+                a[r * n + c] *= scale;
+        sym_tridiagonalize(a, n, values, e, tau, w);
+        T *qt = vectors ? a : nullptr;
+        if (vectors)
+        {
+            sym_tridiagonal_q(a, n, tau, w);
+            transpose_in_place(n, a, n);
+        }
+        sym_tridiagonal_qr(values, e, n, qt);
+        for (size_t i = 0; i < n; i++)
+            values[i] /= scale;
+        sym_eigen_sort(values, n, qt);
+        if (vectors)
+            transpose_in_place(n, a, n);
+    }
+
+    // Closed form for a symmetric 2x2 block: one Jacobi rotation.
+    template <typename T>
+    void sym_eigen2(const T *a, T *values, T *vectors)
+    {
+        const T p = a[0], b = a[2], q = a[3];
+        T c = T(1), s = T(0);
+        values[0] = p;
+        values[1] = q;
+        if (b != T(0))
+        {
+            const T zeta = (q - p) / (T(2) * b);
+            const T t = (zeta >= T(0) ? T(1) : T(-1)) / (std::abs(zeta) + std::sqrt(T(1) + zeta * zeta));
+            c = T(1) / std::sqrt(T(1) + t * t);
+            s = t * c;
+            values[0] = p - t * b;
+            values[1] = q + t * b;
+        }
+        // columns (c, -s) and (s, c)
+        if (values[0] <= values[1])
+        {
+            vectors[0] = c;
+            vectors[1] = s;
+            vectors[2] = -s;
+            vectors[3] = c;
+        }
+        else
+        {
+            std::swap(values[0], values[1]);
+            vectors[0] = s;
+            vectors[1] = c;
+            vectors[2] = c;
+            vectors[3] = -s;
+        }
+    }
+
+    // Unit vector spanning the null space of the symmetric 3x3 rows - lambda I:
+    // the largest cross product of two of its rows.
+    template <typename T>
+    Vec3<T> sym_eigen3_vector(const Vec3<T> rows[3], T lambda)
+    {
+        Vec3<T> r0 = rows[0], r1 = rows[1], r2 = rows[2];
+        r0.x -= lambda;
+        r1.y -= lambda;
+        r2.z -= lambda;
+        const Vec3<T> c01 = cross(r0, r1), c02 = cross(r0, r2), c12 = cross(r1, r2);
+        const T d01 = c01.length_square(), d02 = c02.length_square(), d12 = c12.length_square();
+        if (d01 >= d02 && d01 >= d12)
+            return d01 > T(0) ? c01 * (T(1) / std::sqrt(d01)) : Vec3<T>(T(1), T(0), T(0));
+        if (d02 >= d12)
+            return c02 * (T(1) / std::sqrt(d02));
+        return c12 * (T(1) / std::sqrt(d12));
+    }
+
+    // Unit eigenvector for lambda orthogonal to the known unit eigenvector u:
+    // the null vector of rows - lambda I restricted to the plane orthogonal to
+    // u, which stays well defined when lambda is a double eigenvalue.
+    template <typename T>
+    Vec3<T> sym_eigen3_vector(const Vec3<T> rows[3], T lambda, const Vec3<T> &u)
+    {
+        const Vec3<T> x = std::abs(u.x) > std::abs(u.y)
+                              ? Vec3<T>(-u.z, T(0), u.x) * (T(1) / std::sqrt(u.x * u.x + u.z * u.z))
+                              : Vec3<T>(T(0), u.z, -u.y) * (T(1) / std::sqrt(u.y * u.y + u.z * u.z));
+        const Vec3<T> y = cross(u, x);
+        const Vec3<T> ax(rows[0].dot(x), rows[1].dot(x), rows[2].dot(x));
+        const Vec3<T> ay(rows[0].dot(y), rows[1].dot(y), rows[2].dot(y));
+        T m00 = x.dot(ax) - lambda, m01 = x.dot(ay), m11 = y.dot(ay) - lambda;
+        const T abs00 = std::abs(m00), abs01 = std::abs(m01), abs11 = std::abs(m11);
+        if (abs00 >= abs11)
+        {
+            if (std::max(abs00, abs01) == T(0))
+                return x;
+            if (abs00 >= abs01)
+            {
+                m01 /= m00;
+                m00 = T(1) / std::sqrt(T(1) + m01 * m01);
+                m01 *= m00;
+            }
+            else
+            {
+                m00 /= m01;
+                m01 = T(1) / std::sqrt(T(1) + m00 * m00);
+                m00 *= m01;
+            }
+            return m01 * x - m00 * y;
+        }
+        if (std::max(abs11, abs01) == T(0))
+            return x;
+        if (abs11 >= abs01)
+        {
+            m01 /= m11;
+            m11 = T(1) / std::sqrt(T(1) + m01 * m01);
+            m01 *= m11;
+        }
+        else
+        {
+            m11 /= m01;
+            m01 = T(1) / std::sqrt(T(1) + m11 * m11);
+            m11 *= m01;
+        }
+        return m11 * x - m01 * y;
+    }
+
+    // Closed form for a symmetric 3x3 block. Eigenvalues come from the
+    // trigonometric solution of the characteristic cubic; the vector of the
+    // best separated one from cross products, the middle one inside the plane
+    // orthogonal to it, and the last as their cross product. The matrix is
+    // scaled by its largest element first so nothing overflows.
+    template <typename T>
+    void sym_eigen3(const T *a, T *values, T *vectors)
+    {
+        const T a00 = a[0], a01 = a[3], a02 = a[6], a11 = a[4], a12 = a[7], a22 = a[8];
+        T scale = std::abs(a00);
+        for (T x : { a01, a02, a11, a12, a22 })
+            scale = std::max(scale, std::abs(x));
+        std::fill(vectors, vectors + 9, T(0));
+        if (scale == T(0) || (a01 == T(0) && a02 == T(0) && a12 == T(0)))
+        {
+            std::array<size_t, 3> order = { 0, 1, 2 };
+            const T diagonal[3] = { a00, a11, a22 };
+            std::sort(order.begin(), order.end(), [&](size_t l, size_t r) { return diagonal[l] < diagonal[r]; });
+            for (size_t i = 0; i < 3; i++)
+            {
+                values[i] = diagonal[order[i]];
+                vectors[order[i] * 3 + i] = T(1);
+            }
+            return;
+        }
+
+        const T inv = T(1) / scale;
+        const Vec3<T> rows[3] = { { a00 * inv, a01 * inv, a02 * inv },
+                                  { a01 * inv, a11 * inv, a12 * inv },
+                                  { a02 * inv, a12 * inv, a22 * inv } };
+        const T off = rows[0].y * rows[0].y + rows[0].z * rows[0].z + rows[1].z * rows[1].z;
+        const T q = (rows[0].x + rows[1].y + rows[2].z) / T(3);
+        const T b00 = rows[0].x - q, b11 = rows[1].y - q, b22 = rows[2].z - q;
+        const T p = std::sqrt((b00 * b00 + b11 * b11 + b22 * b22 + T(2) * off) / T(6));
+        const T det = b00 * (b11 * b22 - rows[1].z * rows[1].z) - rows[0].y * (rows[0].y * b22 - rows[1].z * rows[0].z) +
+                      rows[0].z * (rows[0].y * rows[1].z - b11 * rows[0].z);
+        const T half_det = std::min(T(1), std::max(T(-1), det / (T(2) * p * p * p)));
+        const T phi = std::acos(half_det) / T(3);
+        const T third = T(2.09439510239319549230842892218633526);
+        const T l2 = q + T(2) * p * std::cos(phi);
+        const T l0 = q + T(2) * p * std::cos(phi + third);
+        const T l1 = T(3) * q - l0 - l2;
+
+        Vec3<T> v0, v1, v2;
+        if (l2 - l1 >= l1 - l0)
+        {
+            v2 = sym_eigen3_vector(rows, l2);
+            v1 = sym_eigen3_vector(rows, l1, v2);
+            v0 = cross(v1, v2);
+        }
+        else
+        {
+            v0 = sym_eigen3_vector(rows, l0);
+            v1 = sym_eigen3_vector(rows, l1, v0);
+            v2 = cross(v0, v1);
+        }
+        // The cubic loses about half the digits near a double root; Rayleigh
+        // quotients of the vectors get them back.
+        Vec3<T> columns[3] = { v0, v1, v2 };
+        T rayleigh[3];
+        for (size_t i = 0; i < 3; i++)
+        {
+            const Vec3<T> &x = columns[i];
+            rayleigh[i] = x.dot(Vec3<T>(rows[0].dot(x), rows[1].dot(x), rows[2].dot(x)));
+        }
+        std::array<size_t, 3> order = { 0, 1, 2 };
+        std::sort(order.begin(), order.end(), [&](size_t l, size_t r) { return rayleigh[l] < rayleigh[r]; });
+        for (size_t c = 0; c < 3; c++)
+        {
+            values[c] = rayleigh[order[c]] * scale;
+            for (size_t r = 0; r < 3; r++)
+                vectors[r * 3 + c] = columns[order[c]][r];
+        }
+    }
+
+    // Reduces the row-major n x m block a (n >= m) to upper bidiagonal form
+    // Q^T a P with diagonal d (m) and superdiagonal f (m - 1). Left reflector
+    // j is kept in column j below the diagonal (tauq[j]), right reflector j in
+    // row j from column j + 1 on with an explicit leading 1 (taup[j]).
+    // w needs n elements and z m.
+    template <typename T>
+    void svd_bidiagonalize(T *a, size_t n, size_t m, T *d, T *f, T *tauq, T *taup, T *w, T *z)
+    {
+        for (size_t j = 0; j < m; j++)
+        {
+            for (size_t r = j; r < n; r++)
+                w[r] = a[r * m + j];
+            d[j] = eigen_reflector(w + j, n - j, tauq[j]);
+            for (size_t r = j + 1; r < n; r++)
+                a[r * m + j] = w[r];
+            if (tauq[j] != T(0) && j + 1 < m)
+            {
+                // columns j+1 .. m-1: z = v^T A, A -= tau v z
+                std::fill(z + j + 1, z + m, T(0));
+                for (size_t r = j; r < n; r++)
+                {
+                    const T vr = w[r];
+                    const T *row = a + r * m;
+                    for (size_t c = j + 1; c < m; c++)
+                        z[c] += vr * row[c];
+                }
+                for (size_t r = j; r < n; r++)
+                {
+                    const T vr = tauq[j] * w[r];
+                    T *row = a + r * m;
+                    for (size_t c = j + 1; c < m; c++)
+                        row[c] -= vr * z[c];
+                }
+            }
+            if (j + 1 >= m)
+                continue;
+
+            // rows j+1 .. n-1: A -= tau (A u) u^T, one row at a time
+            T *u = a + j * m + j + 1;
+            const size_t len = m - j - 1;
+            f[j] = eigen_reflector(u, len, taup[j]);
+            if (taup[j] == T(0))
+                continue;
+            for (size_t r = j + 1; r < n; r++)
+            {
+                T *row = a + r * m + j + 1;
+                const T x = taup[j] * eigen_dot(row, u, len);
+                for (size_t c = 0; c < len; c++)
+                    row[c] -= x * u[c];
+            }
+        }
+    }
+
+    // Applies y <- y (I - tau v v^T) to rows [r0, r1) of y, over columns
+    // [c0, c0 + len).
+    template <typename T>
+    void eigen_reflect_rows(T *y, size_t ldy, size_t r0, size_t r1, size_t c0, const T *v, size_t len, T tau)
+    {
+        for (size_t r = r0; r < r1; r++)
+        {
+            T *row = y + r * ldy + c0;
+            const T x = tau * eigen_dot(row, v, len);
+            for (size_t c = 0; c < len; c++)
+                row[c] -= x * v[c];
+        }
+    }
+
+    // One implicit QR step with Wilkinson shift on the unreduced block
+    // [start, end] of the bidiagonal (d, f): alternating right and left Givens
+    // rotations chase the bulge down. Right rotations go to the rows of vt
+    // (k x k), left ones to the rows of ut (k x len), when not null.
+    template <typename T>
+    void svd_bidiagonal_qr_step(T *d, T *f, size_t start, size_t end, T *ut, size_t len, T *vt, size_t k)
+    {
+        // shift: eigenvalue of the trailing 2x2 of B^T B nearer its last entry
+        const T t11 = d[end - 1] * d[end - 1] + (end - 1 > start ? f[end - 2] * f[end - 2] : T(0));
+        const T t12 = d[end - 1] * f[end - 1];
+        const T t22 = d[end] * d[end] + f[end - 1] * f[end - 1];
+        const T td = (t11 - t22) / T(2);
+        T mu = t22;
+        if (td == T(0))
+            mu -= std::abs(t12);
+        else
+        {
+            const T h = eigen_hypot(td, t12);
+            mu -= t12 * (t12 / (td + (td > T(0) ? h : -h)));
+        }
+
+        T y = d[start] * d[start] - mu;
+        T z = d[start] * f[start];
+        for (size_t i = start; i < end; i++)
+        {
+            // columns i, i+1
+            T c, s;
+            const T r = eigen_givens(y, z, c, s);
+            if (i > start)
+                f[i - 1] = r;
+            const T di = d[i], fi = f[i];
+            d[i] = c * di + s * fi;
+            f[i] = c * fi - s * di;
+            T bulge = s * d[i + 1];
+            d[i + 1] *= c;
+            if (vt)
+                eigen_rotate(vt + i * k, vt + (i + 1) * k, k, c, s);
+
+            // rows i, i+1
+            d[i] = eigen_givens(d[i], bulge, c, s);
+            const T fi2 = f[i], di1 = d[i + 1];
+            f[i] = c * fi2 + s * di1;
+            d[i + 1] = c * di1 - s * fi2;
+            if (i + 1 < end)
+            {
+                bulge = s * f[i + 1];
+                f[i + 1] *= c;
+            }
+            if (ut)
+                eigen_rotate(ut + i * len, ut + (i + 1) * len, len, c, s);
+            y = f[i];
+            z = bulge;
+        }
+    }
+
+    // Singular values of the upper bidiagonal (d, f) of size k into d,
+    // unsorted and possibly negative. Rotations from the left go to the rows
+    // of ut (k x len), from the right to the rows of vt (k x k), when not null.
+    template <typename T>
+    void svd_bidiagonal_qr(T *d, T *f, size_t k, T *ut, size_t len, T *vt)
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        const T tiny = std::numeric_limits<T>::min();
+        T norm = T(0);
+        for (size_t i = 0; i < k; i++)
+            norm = std::max(norm, std::abs(d[i]) + (i + 1 < k ? std::abs(f[i]) : T(0)));
+        const size_t max_iterations = MUTH_EIGEN_MAX_ITERATIONS * k;
+        size_t iterations = 0;
+        size_t end = k ? k - 1 : 0;
+        while (end > 0)
+        {
+            for (size_t i = 0; i < end; i++)
+                if (std::abs(f[i]) <= eps * (std::abs(d[i]) + std::abs(d[i + 1])) || std::abs(f[i]) < tiny)
+                    f[i] = T(0);
+            while (end > 0 && f[end - 1] == T(0))
+                end--;
+            if (end == 0)
+                break;
+            if (++iterations > max_iterations)
+                throw MuthExceptionInvalidOperation("singular value iteration did not converge");
+            size_t start = end - 1;
+            while (start > 0 && f[start - 1] != T(0))
+                start--;
+
+            // A zero on the diagonal splits the block once its row (or, for
+            // the last one, its column) is rotated clear.
+            size_t zero = end + 1;
+            for (size_t i = start; i <= end; i++)
+                if (std::abs(d[i]) <= eps * norm)
+                {
+                    d[i] = T(0);
+                    zero = i;
+                    break;
+                }
+            if (zero < end)
+            {
+                T bulge = f[zero];
+                f[zero] = T(0);
+                for (size_t i = zero + 1; i <= end && bulge != T(0); i++)
+                {
+                    // rows i, zero: (d[i], bulge) -> (r, 0)
+                    T c, s;
+                    d[i] = eigen_givens(d[i], bulge, c, s);
+                    if (i < end)
+                    {
+                        bulge = -s * f[i];
+                        f[i] *= c;
+                    }
+                    if (ut)
+                        eigen_rotate(ut + i * len, ut + zero * len, len, c, s);
+                }
+                continue;
+            }
+            if (zero == end)
+            {
+                T bulge = f[end - 1];
+                f[end - 1] = T(0);
+                for (size_t i = end; i-- > start && bulge != T(0);)
+                {
+                    // columns i, end: (d[i], bulge) -> (r, 0)
+                    T c, s;
+                    d[i] = eigen_givens(d[i], bulge, c, s);
+                    if (i > start)
+                    {
+                        bulge = -s * f[i - 1];
+                        f[i - 1] *= c;
+                    }
+                    if (vt)
+                        eigen_rotate(vt + i * k, vt + end * k, k, c, s);
+                }
+                continue;
+            }
+            svd_bidiagonal_qr_step(d, f, start, end, ut, len, vt, k);
+        }
+    }
+
+    // Thin SVD of the row-major n x m block a with n >= m: a = U diag(s) V^T
+    // with s (m) descending, U (n x m) and V (m x m) row-major with
+    // orthonormal columns. u and v may be null to skip them; a is
+    // overwritten. work needs svd_work_size(n, m) elements.
+    template <typename T>
+    void svd_factor(T *a, size_t n, size_t m, T *s, T *u, T *v, T *work)
+    {
+        if (m == 0)
+            return;
+        T *f = work;
+        T *tauq = f + m;
+        T *taup = tauq + m;
+        T *z = taup + m;
+        T *w = z + m;
+        T *ut = w + n;
+        T *vt = ut + m * n;
+        T amax = T(0);
+        for (size_t i = 0; i < n * m; i++)
+            amax = std::max(amax, std::abs(a[i]));
+        const T scale = eigen_scale(amax);
+        for (size_t i = 0; i < n * m; i++)
+            a[i] *= scale;
+        svd_bidiagonalize(a, n, m, s, f, tauq, taup, w, z);
+
+        // U^T = [I 0] H_{m-1} ... H_0 and V^T = G_{m-2} ... G_0, built from
+        // the last reflector back so each one touches only its trailing rows.
+        if (u)
+        {
+            std::fill(ut, ut + m * n, T(0));
+            for (size_t i = 0; i < m; i++)
+                ut[i * n + i] = T(1);
+            for (size_t j = m; j-- > 0;)
+            {
+                if (tauq[j] == T(0))
+                    continue;
+                w[j] = T(1);
+                for (size_t r = j + 1; r < n; r++)
+                    w[r] = a[r * m + j];
+                eigen_reflect_rows(ut, n, j, m, j, w + j, n - j, tauq[j]);
+            }
+        }
+        if (v)
+        {
+            std::fill(vt, vt + m * m, T(0));
+            for (size_t i = 0; i < m; i++)
+                vt[i * m + i] = T(1);
+            for (size_t j = m - 1; j-- > 0;)
+                if (taup[j] != T(0))
+                    eigen_reflect_rows(vt, m, j + 1, m, j + 1, a + j * m + j + 1, m - j - 1, taup[j]);
+        }
+        svd_bidiagonal_qr(s, f, m, u ? ut : nullptr, n, v ? vt : nullptr);
+
+        for (size_t i = 0; i < m; i++)
+        {
+            s[i] /= scale;
+            if (s[i] < T(0))
+            {
+                s[i] = -s[i];
+                if (v)
+                    for (size_t c = 0; c < m; c++)
+                        vt[i * m + c] = -vt[i * m + c];
+            }
+        }
+        for (size_t i = 0; i + 1 < m; i++)
+        {
+            size_t largest = i;
+            for (size_t j = i + 1; j < m; j++)
+                if (s[j] > s[largest])
+                    largest = j;
+            if (largest == i)
+                continue;
+            std::swap(s[i], s[largest]);
+            if (u)
+                std::swap_ranges(ut + i * n, ut + i * n + n, ut + largest * n);
+            if (v)
+                std::swap_ranges(vt + i * m, vt + i * m + m, vt + largest * m);
+        }
+        if (u)
+            transpose(m, n, ut, n, u, m);
+        if (v)
+            transpose(m, m, vt, m, v, m);
+    }
+
+    // Closed form for a 2x2 block: M = R(phi) diag(s0, s1) R(theta)^T with
+    // R(x) the rotation by x, from the split of M into a similarity and an
+    // anti-similarity part.
+    template <typename T>
+    void svd2(const T *a, T *s, T *u, T *v)
+    {
+        const T e = (a[0] + a[3]) / T(2), f = (a[0] - a[3]) / T(2);
+        const T g = (a[2] + a[1]) / T(2), h = (a[2] - a[1]) / T(2);
+        const T q = eigen_hypot(e, h), r = eigen_hypot(f, g);
+        const T a1 = std::atan2(g, f), a2 = std::atan2(h, e);
+        const T theta = (a2 - a1) / T(2), phi = (a2 + a1) / T(2);
+        const T cp = std::cos(phi), sp = std::sin(phi);
+        const T ct = std::cos(theta), st = std::sin(theta);
+        s[0] = q + r;
+        s[1] = q - r;
+        const T flip = s[1] < T(0) ? T(-1) : T(1);
+        s[1] *= flip;
+        if (u)
+        {
+            u[0] = cp;
+            u[1] = -sp * flip;
+            u[2] = sp;
+            u[3] = cp * flip;
+        }
+        if (v)
+        {
+            v[0] = ct;
+            v[1] = st;
+            v[2] = -st;
+            v[3] = ct;
+        }
+    }
+
+    // Eigen decomposition of a symmetric Matrix: eigenvalues ascending and
+    // the matching orthonormal eigenvectors as columns. Only the lower
+    // triangle of the input is read. 2x2 and 3x3 matrices use closed forms.
+    template <typename T, size_t n>
+    struct SymmetricEigen
+    {
+    private:
+        Vector<T, n> values;
+        Matrix<T, n, n> vectors;
+
+    public:
+        SymmetricEigen(const Matrix<T, n, n> &mat, bool compute_vectors = true);
+
+        const Vector<T, n> &eigenvalues() const { return values; }
+        // Zero when constructed without vectors.
+        const Matrix<T, n, n> &eigenvectors() const { return vectors; }
+    };
+
+    template <typename T, size_t n>
+    SymmetricEigen<T, n>::SymmetricEigen(const Matrix<T, n, n> &mat, bool compute_vectors)
+    {
+        if constexpr (n == 2)
+            sym_eigen2(mat.elements, values.elements, vectors.elements);
+        else if constexpr (n == 3)
+            sym_eigen3(mat.elements, values.elements, vectors.elements);
+        else
+        {
+            vectors = mat;
+            if constexpr (sym_eigen_work_size(n) <= 1024)
+            {
+                std::array<T, sym_eigen_work_size(n)> work;
+                sym_eigen(vectors.elements, n, values.elements, compute_vectors, work.data());
+            }
+            else
+            {
+                std::vector<T> work(sym_eigen_work_size(n));
+                sym_eigen(vectors.elements, n, values.elements, compute_vectors, work.data());
+            }
+        }
+        if (!compute_vectors)
+            vectors = Matrix<T, n, n>();
+    }
+
+    // Thin singular value decomposition of an n x m Matrix,
+    // mat = U diag(s) V^T with k = min(n, m) singular values descending. 2x2
+    // matrices use a closed form.
+    template <typename T, size_t n, size_t m>
+    struct SVD
+    {
+        static constexpr size_t k = n < m ? n : m;
+
+    private:
+        Vector<T, k> s;
+        Matrix<T, n, k> u;
+        Matrix<T, m, k> v;
+
+    public:
+        SVD(const Matrix<T, n, m> &mat, bool compute_vectors = true);
+
+        const Vector<T, k> &singular_values() const { return s; }
+        // Zero when constructed without vectors.
+        const Matrix<T, n, k> &U() const { return u; }
+        const Matrix<T, m, k> &V() const { return v; }
+
+        // Ratio of the largest to the smallest singular value; infinite for a
+        // rank-deficient matrix.
+        T cond() const { return s[k - 1] > T(0) ? s[0] / s[k - 1] : std::numeric_limits<T>::infinity(); }
+        // Singular values above tol, by default max(n, m) eps s[0].
+        size_t rank(T tol = T(-1)) const;
+    };
+
+    template <typename T, size_t n, size_t m>
+    SVD<T, n, m>::SVD(const Matrix<T, n, m> &mat, bool compute_vectors)
+    {
+        if constexpr (n == 2 && m == 2)
+        {
+            svd2(mat.elements, s.elements, compute_vectors ? u.elements : nullptr, compute_vectors ? v.elements : nullptr);
+            return;
+        }
+        else
+        {
+            constexpr size_t tall = n > m ? n : m;
+            constexpr size_t work_size = svd_work_size(tall, k);
+            Matrix<T, tall, k> a;
+            if constexpr (n >= m)
+                a = mat;
+            else
+                a = mat.transform();
+            T *left = compute_vectors ? (n >= m ? u.elements : v.elements) : nullptr;
+            T *right = compute_vectors ? (n >= m ? v.elements : u.elements) : nullptr;
+            if constexpr (work_size <= 1024)
+            {
+                std::array<T, work_size> work;
+                svd_factor(a.elements, tall, k, s.elements, left, right, work.data());
+            }
+            else
+            {
+                std::vector<T> work(work_size);
+                svd_factor(a.elements, tall, k, s.elements, left, right, work.data());
+            }
+        }
+    }
+
+    template <typename T, size_t n, size_t m>
+    size_t SVD<T, n, m>::rank(T tol) const
+    {
+        if (tol < T(0))
+            tol = T(n > m ? n : m) * std::numeric_limits<T>::epsilon() * s[0];
+        size_t r = 0;
+        while (r < k && s[r] > tol)
+            r++;
+        return r;
+    }
+
+    // Same as SymmetricEigen for a square DynMatrix or a view of either
+    // layout.
+    template <typename T>
+    struct DynSymmetricEigen
+    {
+    private:
+        DynVector<T> values;
+        DynMatrix<T> vectors;
+
+    public:
+        DynSymmetricEigen(const MatrixView<const T> &mat, bool compute_vectors = true) : values(mat.rows()), vectors(mat.clone()) { factor(compute_vectors); }
+        DynSymmetricEigen(const MatrixView<const T, Layout::ColMajor> &mat, bool compute_vectors = true) : values(mat.rows()), vectors(mat.clone()) { factor(compute_vectors); }
+        // The input is copied, so a temporary DynMatrix is fine (see DynLU).
+        DynSymmetricEigen(const DynMatrix<T> &mat, bool compute_vectors = true) : DynSymmetricEigen(MatrixView<const T>(mat), compute_vectors) {}
+
+        size_t size() const { return values.size(); }
+        const DynVector<T> &eigenvalues() const { return values; }
+        // Zero when constructed without vectors.
+        const DynMatrix<T> &eigenvectors() const { return vectors; }
+
+    private:
+        void factor(bool compute_vectors);
+    };
+
+    template <typename T>
+    void DynSymmetricEigen<T>::factor(bool compute_vectors)
+    {
+        if (vectors.rows() != vectors.cols())
+            throw MuthExceptionInvalidOperation("trying to decompose a non-square matrix");
+        std::vector<T> work(sym_eigen_work_size(size()));
+        sym_eigen(vectors.elements, size(), values.elements, compute_vectors, work.data());
+        if (!compute_vectors)
+            vectors = DynMatrix<T>(size(), size());
+    }
+
+    // Same as SVD for a DynMatrix or a view of either layout.
+    template <typename T>
+    struct DynSVD
+    {
+    private:
+        DynVector<T> s;
+        DynMatrix<T> u;
+        DynMatrix<T> v;
+
+    public:
+        DynSVD(const MatrixView<const T> &mat, bool compute_vectors = true) { factor(mat, compute_vectors); }
+        DynSVD(const MatrixView<const T, Layout::ColMajor> &mat, bool compute_vectors = true) { factor(mat.transpose(), compute_vectors, true); }
+        DynSVD(const DynMatrix<T> &mat, bool compute_vectors = true) : DynSVD(MatrixView<const T>(mat), compute_vectors) {}
+
+        const DynVector<T> &singular_values() const { return s; }
+        // Zero when constructed without vectors.
+        const DynMatrix<T> &U() const { return u; }
+        const DynMatrix<T> &V() const { return v; }
+
+        T cond() const;
+        size_t rank(T tol = T(-1)) const;
+
+    private:
+        void factor(const MatrixView<const T> &mat, bool compute_vectors, bool transposed = false);
+    };
+
+    // Factors mat, or mat^T when transposed is set, always through its tall
+    // orientation.
+    template <typename T>
+    void DynSVD<T>::factor(const MatrixView<const T> &mat, bool compute_vectors, bool transposed)
+    {
+        const size_t rows = mat.rows(), cols = mat.cols();
+        const bool wide = rows < cols;
+        const size_t tall = wide ? cols : rows, k = wide ? rows : cols;
+        DynMatrix<T> a = wide ? mat.transpose().clone() : mat.clone();
+        DynMatrix<T> left(tall, k), right(k, k);
+        s = DynVector<T>(k);
+        std::vector<T> work(svd_work_size(tall, k));
+        svd_factor(a.elements, tall, k, s.elements, compute_vectors ? left.elements : nullptr,
+                   compute_vectors ? right.elements : nullptr, work.data());
+        // mat = left S right^T, or right S left^T when it was wide; the
+        // transposed input swaps the roles once more.
+        if (wide != transposed)
+        {
+            u = std::move(right);
+            v = std::move(left);
+        }
+        else
+        {
+            u = std::move(left);
+            v = std::move(right);
+        }
+    }
+
+    template <typename T>
+    T DynSVD<T>::cond() const
+    {
+        const size_t k = s.size();
+        if (!k)
+            return T(0);
+        return s[k - 1] > T(0) ? s[0] / s[k - 1] : std::numeric_limits<T>::infinity();
+    }
+
+    template <typename T>
+    size_t DynSVD<T>::rank(T tol) const
+    {
+        const size_t k = s.size();
+        if (!k)
+            return 0;
+        if (tol < T(0))
+            tol = T(std::max(u.rows(), v.rows())) * std::numeric_limits<T>::epsilon() * s[0];
+        size_t r = 0;
+        while (r < k && s[r] > tol)
+            r++;
+        return r;
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
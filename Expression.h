@@ -0,0 +1,186 @@
+#ifndef MUTH_EXPRESSION_H
+#define MUTH_EXPRESSION_H
+
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+namespace Muth
+{
+
+    // Element-wise arithmetic on Vector / Matrix builds a tree of lightweight
+    // nodes instead of temporaries; the tree is walked once, element by element,
+    // when it is assigned to a concrete object. Nodes hold named containers by
+    // reference, so do not keep an expression alive past them; temporaries
+    // (e.g. the Vector of A * x in `auto r = A * x - y`) and nested nodes are
+    // held by value.
+
+    struct ExprNode {};
+
+    // Containers specialize this with leaf = true and a flat element accessor.
+    template <typename E, typename = void>
+    struct ExprTraits
+    {
+        static constexpr bool is_expr = false;
+        static constexpr bool leaf = false;
+    };
+
+    template <typename E>
+    struct ExprTraits<E, std::enable_if_t<std::is_base_of<ExprNode, E>::value>>
+    {
+        static constexpr bool is_expr = true;
+        static constexpr bool leaf = false;
+        using value_type = typename E::value_type;
+        using result_type = typename E::result_type;
+        static constexpr size_t size = E::size;
+        static constexpr value_type at(const E &expr, size_t i) { return expr.at(i); }
+    };
+
+    // What a node stores for an operator argument of forwarded type A:
+    // a reference to an lvalue container, otherwise a copy (moved from the
+    // temporary).
+    template <typename A>
+    using ExprOperand = std::conditional_t<std::is_lvalue_reference<A>::value && ExprTraits<std::decay_t<A>>::leaf,
+                                           const std::decay_t<A> &, const std::decay_t<A>>;
+
+    template <typename E>
+    using EnableIfExpr = std::enable_if_t<ExprTraits<E>::is_expr>;
+
+    template <typename L, typename R>
+    using EnableIfSameShape = std::enable_if_t<ExprTraits<std::decay_t<L>>::is_expr && ExprTraits<std::decay_t<R>>::is_expr &&
+                                               std::is_same<typename ExprTraits<std::decay_t<L>>::result_type,
+                                                            typename ExprTraits<std::decay_t<R>>::result_type>::value>;
+
+    // Accepted by the assigning members of result: any expression of that shape.
+    template <typename E, typename result>
+    using EnableIfExprOf = std::enable_if_t<ExprTraits<E>::is_expr &&
+                                            std::is_same<typename ExprTraits<E>::result_type, result>::value>;
+
+    // Same, excluding the container itself so copy construction stays trivial.
+    template <typename E, typename result>
+    using EnableIfNodeOf = std::enable_if_t<ExprTraits<E>::is_expr && !ExprTraits<E>::leaf &&
+                                            std::is_same<typename ExprTraits<E>::result_type, result>::value>;
+
+    struct AddOp { template <typename T> static constexpr T apply(const T &a, const T &b) { return a + b; } };
+    struct SubOp { template <typename T> static constexpr T apply(const T &a, const T &b) { return a - b; } };
+    struct MulOp { template <typename T> static constexpr T apply(const T &a, const T &b) { return a * b; } };
+    struct DivOp { template <typename T> static constexpr T apply(const T &a, const T &b) { return a / b; } };
+    struct NegOp { template <typename T> static constexpr T apply(const T &a) { return -a; } };
+
+    // Node operands are named by the argument types the operators deduced, so
+    // an lvalue operand appears as a reference type (see ExprOperand).
+    template <typename Op, typename L, typename R>
+    struct BinaryExpr : ExprNode
+    {
+        using LeftTraits = ExprTraits<std::decay_t<L>>;
+        using RightTraits = ExprTraits<std::decay_t<R>>;
+        using value_type = typename LeftTraits::value_type;
+        using result_type = typename LeftTraits::result_type;
+        static constexpr size_t size = LeftTraits::size;
+
+        ExprOperand<L> left;
+        ExprOperand<R> right;
+
+        template <typename A, typename B>
+        constexpr BinaryExpr(A &&left, B &&right) : left(std::forward<A>(left)), right(std::forward<B>(right)) {}
+
+        constexpr value_type at(size_t i) const { return Op::apply(value_type(LeftTraits::at(left, i)), value_type(RightTraits::at(right, i))); }
+        constexpr result_type eval() const { return result_type(*this); }
+    };
+
+    template <typename Op, typename E>
+    struct ScalarExpr : ExprNode
+    {
+        using Traits = ExprTraits<std::decay_t<E>>;
+        using value_type = typename Traits::value_type;
+        using result_type = typename Traits::result_type;
+        static constexpr size_t size = Traits::size;
+
+        ExprOperand<E> expr;
+        value_type lambda;
+
+        template <typename A>
+        constexpr ScalarExpr(A &&expr, const value_type &lambda) : expr(std::forward<A>(expr)), lambda(lambda) {}
+
+        constexpr value_type at(size_t i) const { return Op::apply(value_type(Traits::at(expr, i)), lambda); }
+        constexpr result_type eval() const { return result_type(*this); }
+    };
+
+    template <typename Op, typename E>
+    struct UnaryExpr : ExprNode
+    {
+        using Traits = ExprTraits<std::decay_t<E>>;
+        using value_type = typename Traits::value_type;
+        using result_type = typename Traits::result_type;
+        static constexpr size_t size = Traits::size;
+
+        ExprOperand<E> expr;
+
+        template <typename A>
+        constexpr UnaryExpr(A &&expr) : expr(std::forward<A>(expr)) {}
+
+        constexpr value_type at(size_t i) const { return Op::apply(value_type(Traits::at(expr, i))); }
+        constexpr result_type eval() const { return result_type(*this); }
+    };
+
+    template <typename E, typename = EnableIfExpr<E>>
+    constexpr std::conditional_t<ExprTraits<E>::leaf, const E &, typename ExprTraits<E>::result_type> eval(const E &expr)
+    {
+        return expr;
+    }
+
+    template <typename L, typename R, typename = EnableIfSameShape<L, R>>
+    constexpr BinaryExpr<AddOp, L, R> operator+(L &&left, R &&right)
+    {
+        return { std::forward<L>(left), std::forward<R>(right) };
+    }
+
+    template <typename L, typename R, typename = EnableIfSameShape<L, R>>
+    constexpr BinaryExpr<SubOp, L, R> operator-(L &&left, R &&right)
+    {
+        return { std::forward<L>(left), std::forward<R>(right) };
+    }
+
+    template <typename E, typename = EnableIfExpr<std::decay_t<E>>>
+    constexpr ScalarExpr<MulOp, E> operator*(E &&expr, typename ExprTraits<std::decay_t<E>>::value_type lambda)
+    {
+        return { std::forward<E>(expr), lambda };
+    }
+
+    template <typename E, typename = EnableIfExpr<std::decay_t<E>>>
+    constexpr ScalarExpr<MulOp, E> operator*(typename ExprTraits<std::decay_t<E>>::value_type lambda, E &&expr)
+    {
+        return { std::forward<E>(expr), lambda };
+    }
+
+    template <typename E, typename = EnableIfExpr<std::decay_t<E>>>
+    constexpr ScalarExpr<DivOp, E> operator/(E &&expr, typename ExprTraits<std::decay_t<E>>::value_type lambda)
+    {
+        return { std::forward<E>(expr), lambda };
+    }
+
+    template <typename E, typename = EnableIfExpr<std::decay_t<E>>>
+    constexpr UnaryExpr<NegOp, E> operator-(E &&expr)
+    {
+        return { std::forward<E>(expr) };
+    }
+
+    // Non element-wise products (dot, matrix product) evaluate their operands first.
+    template <typename L, typename R,
+              typename = std::enable_if_t<ExprTraits<L>::is_expr && ExprTraits<R>::is_expr &&
+                                          !(ExprTraits<L>::leaf && ExprTraits<R>::leaf)>>
+    constexpr auto operator*(const L &left, const R &right) -> decltype(eval(left) * eval(right))
+    {
+        return eval(left) * eval(right);
+    }
+
+    template <typename E, typename = std::enable_if_t<std::is_base_of<ExprNode, E>::value>>
+    inline std::ostream &operator<<(std::ostream &out, const E &expr)
+    {
+        return out << expr.eval();
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
@@ -0,0 +1,325 @@
+#ifndef MUTH_GEMM_H
+#define MUTH_GEMM_H
+
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "NumTool.h"
+#include "Arena.h"
+#include "Storage.h"
+#include "ThreadPool.h"
+
+// Block sizes of the packed kernel: KC x NR panels of the right operand and
+// MR x KC panels of the left one are streamed through an MR x NR register tile.
+#ifndef MUTH_GEMM_MR
+#define MUTH_GEMM_MR 4
+#endif
+#ifndef MUTH_GEMM_NR
+#define MUTH_GEMM_NR 8
+#endif
+#ifndef MUTH_GEMM_MC
+#define MUTH_GEMM_MC 96
+#endif
+#ifndef MUTH_GEMM_KC
+#define MUTH_GEMM_KC 256
+#endif
+#ifndef MUTH_GEMM_NC
+#define MUTH_GEMM_NC 2048
+#endif
+
+// Columns per task when a product is split across the thread pool; rows are
+// split every MUTH_GEMM_MC.
+#ifndef MUTH_GEMM_PARALLEL_NC
+#define MUTH_GEMM_PARALLEL_NC 512
+#endif
+
+// Products with at least this many multiply-adds use the packed kernel.
+#ifndef MUTH_GEMM_BLOCKED_MIN
+#define MUTH_GEMM_BLOCKED_MIN (48 * 48 * 48)
+#endif
+
+namespace Muth
+{
+
+    constexpr size_t gemm_mr = MUTH_GEMM_MR;
+    constexpr size_t gemm_nr = MUTH_GEMM_NR;
+    constexpr size_t gemm_mc = (MUTH_GEMM_MC + gemm_mr - 1) / gemm_mr * gemm_mr;
+    constexpr size_t gemm_kc = MUTH_GEMM_KC;
+    constexpr size_t gemm_nc = (MUTH_GEMM_NC + gemm_nr - 1) / gemm_nr * gemm_nr;
+
+    // Storage order of a strided operand. The leading dimension is the
+    // distance between consecutive rows (RowMajor) or columns (ColMajor), so
+    // a row-major buffer read as ColMajor is its own transpose.
+    enum class Layout
+    {
+        RowMajor,
+        ColMajor
+    };
+
+    constexpr Layout transposed(Layout layout)
+    {
+        return layout == Layout::RowMajor ? Layout::ColMajor : Layout::RowMajor;
+    }
+
+    constexpr size_t row_stride(Layout layout, size_t ld) { return layout == Layout::RowMajor ? ld : 1; }
+    constexpr size_t col_stride(Layout layout, size_t ld) { return layout == Layout::RowMajor ? 1 : ld; }
+
+    // Fully unrolled product for tiny compile-time shapes: out = a(n x m) * b(m x w),
+    // each output summed in accumulator_t<T>.
+    template <typename T, size_t w, size_t... k>
+    constexpr T gemm_unrolled_dot(const T *a, const T *b, std::index_sequence<k...>)
+    {
+        using Acc = accumulator_t<T>;
+        return T(((Acc(a[k]) * Acc(b[k * w])) + ...));
+    }
+
+    template <typename T, size_t m, size_t w, size_t... idx>
+    constexpr void gemm_unrolled(const T *a, const T *b, T *out, std::index_sequence<idx...>)
+    {
+        ((out[idx] = gemm_unrolled_dot<T, w>(a + (idx / w) * m, b + idx % w, std::make_index_sequence<m>())), ...);
+    }
+
+    template <typename T, size_t n, size_t m, size_t w>
+    constexpr void gemm_unrolled(const T *a, const T *b, T *out)
+    {
+        gemm_unrolled<T, m, w>(a, b, out, std::make_index_sequence<n * w>());
+    }
+
+    // c(n x w) += a(n x m) * b(m x w), row-major with leading dimensions.
+    // r-k-c order keeps the innermost loop on contiguous rows of b and c.
+    template <typename T>
+    constexpr void gemm_rkc(size_t n, size_t m, size_t w, const T *a, size_t lda, const T *b, size_t ldb, T *c, size_t ldc)
+    {
+        for (size_t r = 0; r < n; r++)
+        {
+            T *c_row = c + r * ldc;
+            for (size_t k = 0; k < m; k++)
+            {
+                const T a_rk = a[r * lda + k];
+                const T *b_row = b + k * ldb;
+                for (size_t col = 0; col < w; col++)
+                    c_row[col] += a_rk * b_row[col];
+            }
+        }
+    }
+
+    // Same product for operands of either layout; c is row-major. A
+    // row-major b keeps the r-k-c order, a column-major b is walked as dot
+    // products of a's rows with b's contiguous columns.
+    template <typename T>
+    constexpr void gemm_strided(size_t n, size_t m, size_t w, const T *a, size_t lda, Layout la, const T *b, size_t ldb, Layout lb, T *c, size_t ldc)
+    {
+        const size_t rsa = row_stride(la, lda), csa = col_stride(la, lda);
+        if (lb == Layout::RowMajor)
+        {
+            for (size_t r = 0; r < n; r++)
+            {
+                T *c_row = c + r * ldc;
+                for (size_t k = 0; k < m; k++)
+                {
+                    const T a_rk = a[r * rsa + k * csa];
+                    const T *b_row = b + k * ldb;
+                    for (size_t col = 0; col < w; col++)
+                        c_row[col] += a_rk * b_row[col];
+                }
+            }
+            return;
+        }
+        for (size_t r = 0; r < n; r++)
+        {
+            const T *a_row = a + r * rsa;
+            for (size_t col = 0; col < w; col++)
+            {
+                const T *b_col = b + col * ldb;
+                T sum = T(0);
+                for (size_t k = 0; k < m; k++)
+                    sum += a_row[k * csa] * b_col[k];
+                c[r * ldc + col] += sum;
+            }
+        }
+    }
+
+    // c(n x w) += a(n x m) * b(m x w) with products widened to Acc and summed
+    // into an Acc output, so narrow inputs neither overflow nor round per
+    // step. Same r-k-c order as gemm_rkc.
+    template <typename T, typename Acc>
+    void gemm_accumulate(size_t n, size_t m, size_t w, const T *a, size_t lda, Layout la, const T *b, size_t ldb, Layout lb, Acc *c, size_t ldc)
+    {
+        const size_t rsa = row_stride(la, lda), csa = col_stride(la, lda);
+        const size_t rsb = row_stride(lb, ldb), csb = col_stride(lb, ldb);
+        parallel_for(0, n, m * w, parallel_config().gemm_min, [=](size_t lo, size_t hi) {
+            for (size_t r = lo; r < hi; r++)
+            {
+                Acc *c_row = c + r * ldc;
+                for (size_t k = 0; k < m; k++)
+                {
+                    const Acc a_rk = Acc(a[r * rsa + k * csa]);
+                    const T *b_row = b + k * rsb;
+                    for (size_t col = 0; col < w; col++)
+                        c_row[col] += a_rk * Acc(b_row[col * csb]);
+                }
+            }
+        });
+    }
+
+    template <typename T, typename Acc>
+    void gemm_accumulate(size_t n, size_t m, size_t w, const T *a, size_t lda, const T *b, size_t ldb, Acc *c, size_t ldc)
+    {
+        gemm_accumulate(n, m, w, a, lda, Layout::RowMajor, b, ldb, Layout::RowMajor, c, ldc);
+    }
+
+    // Copies an mc x kc block of a into MR-row slivers, column-major within each
+    // sliver; the last sliver is zero-padded. Packing absorbs the layout of
+    // the source, so the micro kernel never sees it.
+    template <typename T>
+    inline void gemm_pack_a(size_t mc, size_t kc, const T *a, size_t lda, Layout la, T *packed)
+    {
+        const size_t rs = row_stride(la, lda), cs = col_stride(la, lda);
+        for (size_t i = 0; i < mc; i += gemm_mr)
+        {
+            const size_t rows = std::min(gemm_mr, mc - i);
+            for (size_t p = 0; p < kc; p++)
+            {
+                for (size_t r = 0; r < rows; r++)
+                    *packed++ = a[(i + r) * rs + p * cs];
+                for (size_t r = rows; r < gemm_mr; r++)
+                    *packed++ = T(0);
+            }
+        }
+    }
+
+    // Copies a kc x nc block of b into NR-column slivers, row-major within each
+    // sliver; the last sliver is zero-padded.
+    template <typename T>
+    inline void gemm_pack_b(size_t kc, size_t nc, const T *b, size_t ldb, Layout lb, T *packed)
+    {
+        const size_t rs = row_stride(lb, ldb), cs = col_stride(lb, ldb);
+        for (size_t j = 0; j < nc; j += gemm_nr)
+        {
+            const size_t cols = std::min(gemm_nr, nc - j);
+            for (size_t p = 0; p < kc; p++)
+            {
+                const T *b_row = b + p * rs + j * cs;
+                for (size_t col = 0; col < cols; col++)
+                    *packed++ = b_row[col * cs];
+                for (size_t col = cols; col < gemm_nr; col++)
+                    *packed++ = T(0);
+            }
+        }
+    }
+
+    // The register tile sums in accumulator_t<T>, so a wider accumulator
+    // costs one rounding into c per KC panel rather than one per product.
+    template <typename T>
+    inline void gemm_micro_kernel(size_t kc, const T *a, const T *b, T *c, size_t ldc, size_t rows, size_t cols)
+    {
+        using Acc = accumulator_t<T>;
+        Acc acc[gemm_mr][gemm_nr] = {};
+        for (size_t p = 0; p < kc; p++, a += gemm_mr, b += gemm_nr)
+            for (size_t i = 0; i < gemm_mr; i++)
+                for (size_t j = 0; j < gemm_nr; j++)
+                    acc[i][j] += Acc(a[i]) * Acc(b[j]);
+        for (size_t i = 0; i < rows; i++)
+            for (size_t j = 0; j < cols; j++)
+                c[i * ldc + j] = T(Acc(c[i * ldc + j]) + acc[i][j]);
+    }
+
+    // Packed, cache-blocked product: c(n x w) += a(n x m) * b(m x w).
+    template <typename T>
+    void gemm_blocked(size_t n, size_t m, size_t w, const T *a, size_t lda, Layout la, const T *b, size_t ldb, Layout lb, T *c, size_t ldc)
+    {
+        const size_t rsa = row_stride(la, lda), csa = col_stride(la, lda);
+        const size_t rsb = row_stride(lb, ldb), csb = col_stride(lb, ldb);
+        DynStorage<T> packed_a(gemm_mc * std::min(gemm_kc, m));
+        DynStorage<T> packed_b(std::min(gemm_kc, m) * std::min(gemm_nc, (w + gemm_nr - 1) / gemm_nr * gemm_nr));
+
+        for (size_t jc = 0; jc < w; jc += gemm_nc)
+        {
+            const size_t nc = std::min(gemm_nc, w - jc);
+            for (size_t pc = 0; pc < m; pc += gemm_kc)
+            {
+                const size_t kc = std::min(gemm_kc, m - pc);
+                gemm_pack_b(kc, nc, b + pc * rsb + jc * csb, ldb, lb, packed_b.elements);
+                for (size_t ic = 0; ic < n; ic += gemm_mc)
+                {
+                    const size_t mc = std::min(gemm_mc, n - ic);
+                    gemm_pack_a(mc, kc, a + ic * rsa + pc * csa, lda, la, packed_a.elements);
+                    for (size_t jr = 0; jr < nc; jr += gemm_nr)
+                        for (size_t ir = 0; ir < mc; ir += gemm_mr)
+                            gemm_micro_kernel(kc, packed_a.elements + ir * kc, packed_b.elements + jr * kc,
+                                              c + (ic + ir) * ldc + jc + jr, ldc,
+                                              std::min(gemm_mr, mc - ir), std::min(gemm_nr, nc - jr));
+                }
+            }
+        }
+    }
+
+    // Packed product with the output split into MC x PARALLEL_NC tiles, each
+    // computed by one pool task. Tiles do not overlap, so no synchronization
+    // is needed beyond waiting for all of them. Packing buffers come from the
+    // worker's own arena instead of the shared global allocator.
+    template <typename T>
+    void gemm_parallel(size_t n, size_t m, size_t w, const T *a, size_t lda, Layout la, const T *b, size_t ldb, Layout lb, T *c, size_t ldc)
+    {
+        const size_t tile_rows = gemm_mc;
+        const size_t tile_cols = MUTH_GEMM_PARALLEL_NC;
+        const size_t tiles_r = (n + tile_rows - 1) / tile_rows;
+        const size_t tiles_c = (w + tile_cols - 1) / tile_cols;
+        ThreadPool::instance().parallel_for(0, tiles_r * tiles_c, 1, [&](size_t lo, size_t hi) {
+            for (size_t tile = lo; tile < hi; tile++)
+            {
+                ArenaScope scope;
+                const size_t r0 = (tile / tiles_c) * tile_rows;
+                const size_t c0 = (tile % tiles_c) * tile_cols;
+                gemm_blocked(std::min(tile_rows, n - r0), m, std::min(tile_cols, w - c0),
+                             a + r0 * row_stride(la, lda), lda, la, b + c0 * col_stride(lb, ldb), ldb, lb, c + r0 * ldc + c0, ldc);
+            }
+        });
+    }
+
+    // c(n x w) += a(n x m) * b(m x w), picking the kernel by problem size.
+    // a and b may each be row- or column-major, so products with transposed
+    // operands need no transposed copy; c is row-major (for a column-major c,
+    // compute c^T = b^T a^T). Floating-point types with a wider
+    // accumulator_t (MUTH_ACCUMULATE_FLOAT_IN_DOUBLE) always take the packed
+    // kernel, which widens in its register tile; other such types (narrow
+    // integers, Half) go through gemm_accumulate and a temporary wide copy
+    // of c, so their sums are exact however long.
+    template <typename T>
+    inline void gemm(size_t n, size_t m, size_t w, const T *a, size_t lda, Layout la, const T *b, size_t ldb, Layout lb, T *c, size_t ldc)
+    {
+        using Acc = accumulator_t<T>;
+        constexpr bool widened = !std::is_same<Acc, T>::value;
+        if constexpr (widened && !std::is_floating_point<T>::value)
+        {
+            std::vector<Acc> wide(n * w);
+            for (size_t r = 0; r < n; r++)
+                for (size_t col = 0; col < w; col++)
+                    wide[r * w + col] = Acc(c[r * ldc + col]);
+            gemm_accumulate(n, m, w, a, lda, la, b, ldb, lb, wide.data(), w);
+            for (size_t r = 0; r < n; r++)
+                for (size_t col = 0; col < w; col++)
+                    c[r * ldc + col] = T(wide[r * w + col]);
+        }
+        else if (parallel_config().enabled && n * m * w >= parallel_config().gemm_min)
+            gemm_parallel(n, m, w, a, lda, la, b, ldb, lb, c, ldc);
+        else if (widened || n * m * w >= MUTH_GEMM_BLOCKED_MIN)
+            gemm_blocked(n, m, w, a, lda, la, b, ldb, lb, c, ldc);
+        else if (la == Layout::RowMajor && lb == Layout::RowMajor)
+            gemm_rkc(n, m, w, a, lda, b, ldb, c, ldc);
+        else
+            gemm_strided(n, m, w, a, lda, la, b, ldb, lb, c, ldc);
+    }
+
+    template <typename T>
+    inline void gemm(size_t n, size_t m, size_t w, const T *a, size_t lda, const T *b, size_t ldb, T *c, size_t ldc)
+    {
+        gemm(n, m, w, a, lda, Layout::RowMajor, b, ldb, Layout::RowMajor, c, ldc);
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
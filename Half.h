@@ -0,0 +1,324 @@
+#ifndef MUTH_HALF_H
+#define MUTH_HALF_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <iostream>
+#include <type_traits>
+
+#include "NumTool.h"
+#include "Simd.h"
+
+namespace Muth
+{
+
+    inline uint32_t float_bits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline float bits_float(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // IEEE 754 binary16: 1 sign, 5 exponent, 10 mantissa bits. Range
+    // +-65504, about 3 decimal digits.
+    struct HalfFormat
+    {
+        static constexpr uint16_t epsilon = 0x1400;  // 2^-10
+        static constexpr uint16_t min = 0x0400;      // 2^-14
+        static constexpr uint16_t max = 0x7BFF;      // 65504
+        static constexpr uint16_t infinity = 0x7C00;
+        static constexpr uint16_t quiet_nan = 0x7E00;
+        static constexpr uint16_t signaling_nan = 0x7D00;
+        static constexpr uint16_t denorm_min = 0x0001;    // 2^-24
+        static constexpr uint16_t round_error = 0x3800;   // 0.5
+        static constexpr int digits = 11;
+        static constexpr int digits10 = 3;
+        static constexpr int max_digits10 = 5;
+        static constexpr int min_exponent = -13;
+        static constexpr int min_exponent10 = -4;
+        static constexpr int max_exponent = 16;
+        static constexpr int max_exponent10 = 4;
+        static constexpr bool is_iec559 = true;
+
+        // Round to nearest even, overflow to infinity, gradual underflow.
+        static uint16_t encode(float value)
+        {
+            const uint32_t f = float_bits(value);
+            const uint32_t sign = (f >> 16) & 0x8000u;
+            const uint32_t abs = f & 0x7FFFFFFFu;
+            if (abs >= 0x7F800000u)
+                return uint16_t(sign | (abs > 0x7F800000u ? quiet_nan : infinity));
+            if (abs >= 0x477FF000u)
+                return uint16_t(sign | infinity);
+            if (abs < 0x38800000u)
+            {
+                if (abs < 0x33000000u)
+                    return uint16_t(sign);
+                const uint32_t shift = 126u - (abs >> 23);
+                const uint32_t mant = (abs & 0x7FFFFFu) | 0x800000u;
+                uint32_t half = mant >> shift;
+                const uint32_t rem = mant & ((1u << shift) - 1u), mid = 1u << (shift - 1u);
+                if (rem > mid || (rem == mid && (half & 1u)))
+                    half++;
+                return uint16_t(sign | half);
+            }
+            uint32_t half = (abs - 0x38000000u) >> 13;
+            const uint32_t rem = abs & 0x1FFFu;
+            if (rem > 0x1000u || (rem == 0x1000u && (half & 1u)))
+                half++;
+            return uint16_t(sign | half);
+        }
+
+        static float decode(uint16_t bits)
+        {
+            const uint32_t sign = uint32_t(bits & 0x8000u) << 16;
+            const uint32_t exp = (bits >> 10) & 0x1Fu;
+            uint32_t mant = bits & 0x3FFu;
+            if (exp == 0x1Fu)
+                return bits_float(sign | 0x7F800000u | (mant << 13));
+            if (exp != 0)
+                return bits_float(sign | ((exp + 112u) << 23) | (mant << 13));
+            if (mant == 0)
+                return bits_float(sign);
+            uint32_t e = 113;
+            while (!(mant & 0x400u))
+            {
+                mant <<= 1;
+                e--;
+            }
+            return bits_float(sign | (e << 23) | ((mant & 0x3FFu) << 13));
+        }
+    };
+
+    // bfloat16: the top half of a binary32, so float's range with 8 mantissa
+    // bits. Conversion from float is a rounding shift.
+    struct BFloat16Format
+    {
+        static constexpr uint16_t epsilon = 0x3C00;  // 2^-7
+        static constexpr uint16_t min = 0x0080;      // 2^-126
+        static constexpr uint16_t max = 0x7F7F;
+        static constexpr uint16_t infinity = 0x7F80;
+        static constexpr uint16_t quiet_nan = 0x7FC0;
+        static constexpr uint16_t signaling_nan = 0x7FA0;
+        static constexpr uint16_t denorm_min = 0x0001;    // 2^-133
+        static constexpr uint16_t round_error = 0x3F00;   // 0.5
+        static constexpr int digits = 8;
+        static constexpr int digits10 = 2;
+        static constexpr int max_digits10 = 4;
+        static constexpr int min_exponent = -125;
+        static constexpr int min_exponent10 = -37;
+        static constexpr int max_exponent = 128;
+        static constexpr int max_exponent10 = 38;
+        static constexpr bool is_iec559 = false;
+
+        static uint16_t encode(float value)
+        {
+            const uint32_t f = float_bits(value);
+            if ((f & 0x7FFFFFFFu) > 0x7F800000u)
+                return uint16_t((f >> 16) | 0x40u);
+            return uint16_t((f + 0x7FFFu + ((f >> 16) & 1u)) >> 16);
+        }
+
+        static float decode(uint16_t bits) { return bits_float(uint32_t(bits) << 16); }
+    };
+
+    // 16-bit storage type computing through float. Converts implicitly to
+    // float, so mixed expressions and std:: math functions run in float;
+    // construction from other types is explicit so that a Half only appears
+    // where rounding was asked for. Half op Half rounds back to Half.
+    template <typename Format>
+    struct Float16
+    {
+    public:
+        uint16_t bits;
+
+    public:
+        constexpr Float16() : bits(0) {}
+        template <typename U, typename = typename std::enable_if<std::is_arithmetic<U>::value>::type>
+        explicit Float16(U value) : bits(Format::encode(float(value))) {}
+
+        static constexpr Float16<Format> from_bits(uint16_t bits)
+        {
+            Float16<Format> result;
+            result.bits = bits;
+            return result;
+        }
+
+        operator float() const { return Format::decode(bits); }
+
+        Float16<Format> &operator+= (Float16<Format> other) { return *this = Float16<Format>(float(*this) + float(other)); }
+        Float16<Format> &operator-= (Float16<Format> other) { return *this = Float16<Format>(float(*this) - float(other)); }
+        Float16<Format> &operator*= (Float16<Format> other) { return *this = Float16<Format>(float(*this) * float(other)); }
+        Float16<Format> &operator/= (Float16<Format> other) { return *this = Float16<Format>(float(*this) / float(other)); }
+    };
+
+    using Half = Float16<HalfFormat>;
+    using BFloat16 = Float16<BFloat16Format>;
+
+    template <typename Format>
+    inline Float16<Format> operator+(Float16<Format> left, Float16<Format> right) { return Float16<Format>(float(left) + float(right)); }
+    template <typename Format>
+    inline Float16<Format> operator-(Float16<Format> left, Float16<Format> right) { return Float16<Format>(float(left) - float(right)); }
+    template <typename Format>
+    inline Float16<Format> operator*(Float16<Format> left, Float16<Format> right) { return Float16<Format>(float(left) * float(right)); }
+    template <typename Format>
+    inline Float16<Format> operator/(Float16<Format> left, Float16<Format> right) { return Float16<Format>(float(left) / float(right)); }
+    template <typename Format>
+    constexpr Float16<Format> operator-(Float16<Format> value) { return Float16<Format>::from_bits(uint16_t(value.bits ^ 0x8000u)); }
+
+    template <typename Format>
+    inline std::ostream &operator<<(std::ostream &out, Float16<Format> value)
+    {
+        return out << float(value);
+    }
+
+    // Sums of 16-bit products are kept in float: bf16 has too few mantissa
+    // bits, and fp16 too little range, to hold a running dot product.
+    template <typename Format>
+    struct Accumulator<Float16<Format>> { using type = float; };
+
+    template <>
+    inline bool nonzero(Half obj) { return std::abs(float(obj)) >= HalfFormat::decode(HalfFormat::epsilon); }
+    template <>
+    inline bool nonzero(BFloat16 obj) { return std::abs(float(obj)) >= BFloat16Format::decode(BFloat16Format::epsilon); }
+
+    template <>
+    inline bool equal(Half x, Half y) { return std::abs(float(x) - float(y)) < HalfFormat::decode(HalfFormat::epsilon); }
+    template <>
+    inline bool equal(BFloat16 x, BFloat16 y) { return std::abs(float(x) - float(y)) < BFloat16Format::decode(BFloat16Format::epsilon); }
+
+    // Bulk conversions. fp16 uses the F16C instructions when the target has
+    // them (8 values per instruction); bf16 uses AVX2 integer shifts.
+    inline void convert(const Half *in, float *out, size_t count)
+    {
+        size_t i = 0;
+#ifdef MUTH_SIMD_F16C
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))));
+#endif
+        for (; i < count; i++)
+            out[i] = float(in[i]);
+    }
+
+    inline void convert(const float *in, Half *out, size_t count)
+    {
+        size_t i = 0;
+#ifdef MUTH_SIMD_F16C
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+#endif
+        for (; i < count; i++)
+            out[i] = Half(in[i]);
+    }
+
+    inline void convert(const BFloat16 *in, float *out, size_t count)
+    {
+        size_t i = 0;
+#ifdef MUTH_SIMD_AVX2
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+            _mm256_storeu_ps(out + i, _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16)));
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = float(in[i]);
+    }
+
+    inline void convert(const float *in, BFloat16 *out, size_t count)
+    {
+        size_t i = 0;
+#ifdef MUTH_SIMD_AVX2
+        const __m256i one = _mm256_set1_epi32(1), bias = _mm256_set1_epi32(0x7FFF), nan = _mm256_set1_epi32(0x7FC0);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 x = _mm256_loadu_ps(in + i);
+            const __m256i f = _mm256_castps_si256(x);
+            const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(f, 16), one);
+            __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(f, bias), odd), 16);
+            const __m256i is_nan = _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+            rounded = _mm256_blendv_epi8(rounded, _mm256_or_si256(_mm256_srli_epi32(f, 16), nan), is_nan);
+            const __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(rounded), _mm256_extracti128_si256(rounded, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = BFloat16(in[i]);
+    }
+
+    // y(n) = a(n x m) * x for 16-bit a and float x, summing in float. Rows
+    // are widened in blocks through convert(), so a only crosses the memory
+    // bus at half width.
+    template <typename Format>
+    void gemv(size_t n, size_t m, const Float16<Format> *a, size_t lda, const float *x, float *y)
+    {
+        constexpr size_t block = 256;
+        float row[block];
+        for (size_t r = 0; r < n; r++)
+        {
+            float sum = 0.0f;
+            for (size_t k0 = 0; k0 < m; k0 += block)
+            {
+                const size_t len = std::min(block, m - k0);
+                convert(a + r * lda + k0, row, len);
+                for (size_t k = 0; k < len; k++)
+                    sum += row[k] * x[k0 + k];
+            }
+            y[r] = sum;
+        }
+    }
+
+} // namespace Muth
+
+namespace std
+{
+    template <typename Format>
+    struct numeric_limits<Muth::Float16<Format>>
+    {
+        static constexpr bool is_specialized = true;
+        static constexpr bool is_signed = true;
+        static constexpr bool is_integer = false;
+        static constexpr bool is_exact = false;
+        static constexpr bool has_infinity = true;
+        static constexpr bool has_quiet_NaN = true;
+        static constexpr bool has_signaling_NaN = true;
+        static constexpr float_denorm_style has_denorm = denorm_present;
+        static constexpr bool has_denorm_loss = false;
+        static constexpr float_round_style round_style = round_to_nearest;
+        static constexpr bool is_iec559 = Format::is_iec559;
+        static constexpr bool is_bounded = true;
+        static constexpr bool is_modulo = false;
+        static constexpr int digits = Format::digits;
+        static constexpr int digits10 = Format::digits10;
+        static constexpr int max_digits10 = Format::max_digits10;
+        static constexpr int radix = 2;
+        static constexpr int min_exponent = Format::min_exponent;
+        static constexpr int min_exponent10 = Format::min_exponent10;
+        static constexpr int max_exponent = Format::max_exponent;
+        static constexpr int max_exponent10 = Format::max_exponent10;
+        static constexpr bool traps = false;
+        static constexpr bool tinyness_before = false;
+
+        static constexpr Muth::Float16<Format> epsilon() { return Muth::Float16<Format>::from_bits(Format::epsilon); }
+        static constexpr Muth::Float16<Format> round_error() { return Muth::Float16<Format>::from_bits(Format::round_error); }
+        static constexpr Muth::Float16<Format> denorm_min() { return Muth::Float16<Format>::from_bits(Format::denorm_min); }
+        static constexpr Muth::Float16<Format> min() { return Muth::Float16<Format>::from_bits(Format::min); }
+        static constexpr Muth::Float16<Format> max() { return Muth::Float16<Format>::from_bits(Format::max); }
+        static constexpr Muth::Float16<Format> lowest() { return Muth::Float16<Format>::from_bits(uint16_t(Format::max | 0x8000u)); }
+        static constexpr Muth::Float16<Format> infinity() { return Muth::Float16<Format>::from_bits(Format::infinity); }
+        static constexpr Muth::Float16<Format> quiet_NaN() { return Muth::Float16<Format>::from_bits(Format::quiet_nan); }
+        static constexpr Muth::Float16<Format> signaling_NaN() { return Muth::Float16<Format>::from_bits(Format::signaling_nan); }
+    };
+} // namespace std
+
+#endif
\ No newline at end of file
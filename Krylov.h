@@ -0,0 +1,517 @@
+#ifndef MUTH_KRYLOV_H
+#define MUTH_KRYLOV_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "Matrix.h"
+#include "DynMatrix.h"
+#include "View.h"
+#include "Sparse.h"
+
+namespace Muth
+{
+
+    // Iterative solvers for A x = b that only need y = A x. The operator can be
+    // a Matrix, DynMatrix, MatrixView, SparseCSR / SparseCSC, or any callable
+    // op(x, y) taking raw element pointers. x holds the initial guess on entry.
+
+    template <typename T>
+    struct SolverOptions
+    {
+        size_t max_iterations = 1000;
+        // Stop once |b - A x| <= tolerance * |b|.
+        T tolerance = std::sqrt(std::numeric_limits<T>::epsilon());
+        // Krylov basis size between GMRES restarts.
+        size_t restart = 30;
+        // Called after every iteration with the iteration count and residual
+        // norm; returning false stops the solver.
+        std::function<bool(size_t, T)> callback;
+    };
+
+    template <typename T>
+    struct SolverResult
+    {
+        size_t iterations = 0;
+        T residual = T(0);
+        bool converged = false;
+    };
+
+    // y = A x for the supported operator types.
+    template <typename T, size_t n>
+    void krylov_apply(const Matrix<T, n, n> &a, const T *x, T *y)
+    {
+        for (size_t r = 0; r < n; r++)
+        {
+            const T *row = a[r];
+            T sum = T(0);
+            for (size_t c = 0; c < n; c++)
+                sum += row[c] * x[c];
+            y[r] = sum;
+        }
+    }
+
+    template <typename T>
+    void krylov_apply(const DynMatrix<T> &a, const T *x, T *y)
+    {
+        for (size_t r = 0; r < a.rows(); r++)
+        {
+            const T *row = a[r];
+            T sum = T(0);
+            for (size_t c = 0; c < a.cols(); c++)
+                sum += row[c] * x[c];
+            y[r] = sum;
+        }
+    }
+
+    template <typename U, Layout L, typename T, typename = EnableIfSameElement<U, T>>
+    void krylov_apply(const MatrixView<U, L> &a, const T *x, T *y)
+    {
+        gemv(VectorView<T>(y, a.rows()), a, VectorView<const T>(x, a.cols()));
+    }
+
+    template <typename T>
+    void krylov_apply(const SparseCSR<T> &a, const T *x, T *y) { spmv(a, x, y); }
+
+    template <typename T>
+    void krylov_apply(const SparseCSC<T> &a, const T *x, T *y) { spmv(a, x, y); }
+
+    template <typename T, typename F>
+    auto krylov_apply(const F &op, const T *x, T *y) -> decltype(op(x, y), void())
+    {
+        op(x, y);
+    }
+
+    // Shape checks; callables are trusted to match b.
+    template <typename T, size_t n>
+    void krylov_check(const Matrix<T, n, n> &, size_t size)
+    {
+        if (n != size)
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+    }
+
+    template <typename Op>
+    auto krylov_check(const Op &a, size_t size) -> decltype(a.rows(), a.cols(), void())
+    {
+        if (a.rows() != size || a.cols() != size)
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+    }
+
+    template <typename F>
+    void krylov_check(const F &, ...) {}
+
+    template <typename T>
+    T krylov_dot(size_t n, const T *a, const T *b)
+    {
+        T sum = T(0);
+        for (size_t i = 0; i < n; i++)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    template <typename T>
+    T krylov_norm(size_t n, const T *a)
+    {
+        return std::sqrt(krylov_dot(n, a, a));
+    }
+
+    // Preconditioners expose z = M^-1 r through apply(r, z, n).
+    template <typename T>
+    struct IdentityPreconditioner
+    {
+        void apply(const T *r, T *z, size_t n) const { std::copy_n(r, n, z); }
+    };
+
+    // Scales by the inverse diagonal.
+    template <typename T>
+    struct JacobiPreconditioner
+    {
+    private:
+        std::vector<T> inv_diag;
+
+        void invert()
+        {
+            for (T &d : inv_diag)
+            {
+                if (d == T(0))
+                    throw MuthExceptionInvalidOperation("Jacobi preconditioner needs a nonzero diagonal");
+                d = T(1) / d;
+            }
+        }
+
+    public:
+        template <size_t n>
+        explicit JacobiPreconditioner(const Matrix<T, n, n> &a) : inv_diag(n)
+        {
+            for (size_t i = 0; i < n; i++)
+                inv_diag[i] = a[i][i];
+            invert();
+        }
+        explicit JacobiPreconditioner(const DynMatrix<T> &a) : inv_diag(std::min(a.rows(), a.cols()))
+        {
+            for (size_t i = 0; i < inv_diag.size(); i++)
+                inv_diag[i] = a[i][i];
+            invert();
+        }
+        explicit JacobiPreconditioner(const SparseCSR<T> &a) : inv_diag(std::min(a.rows(), a.cols()))
+        {
+            for (size_t i = 0; i < inv_diag.size(); i++)
+                inv_diag[i] = a.get(i, i);
+            invert();
+        }
+
+        void apply(const T *r, T *z, size_t n) const
+        {
+            for (size_t i = 0; i < n; i++)
+                z[i] = r[i] * inv_diag[i];
+        }
+    };
+
+    // Incomplete LU with the sparsity pattern of A: L (unit) and U share A's
+    // CSR arrays, fill-in outside the pattern is dropped. Dense inputs are
+    // converted to CSR first.
+    template <typename T>
+    struct ILU0Preconditioner
+    {
+    private:
+        std::vector<size_t> ptr;
+        std::vector<size_t> idx;
+        std::vector<T> vals;
+        std::vector<size_t> diag;
+
+    public:
+        explicit ILU0Preconditioner(const SparseCSR<T> &a);
+        template <size_t n>
+        explicit ILU0Preconditioner(const Matrix<T, n, n> &a) : ILU0Preconditioner(SparseCSR<T>(a)) {}
+        explicit ILU0Preconditioner(const DynMatrix<T> &a) : ILU0Preconditioner(SparseCSR<T>(a)) {}
+
+        void apply(const T *r, T *z, size_t n) const;
+    };
+
+    template <typename T>
+    ILU0Preconditioner<T>::ILU0Preconditioner(const SparseCSR<T> &a)
+        : ptr(a.row_offsets()), idx(a.columns()), vals(a.values()), diag(a.rows())
+    {
+        if (a.rows() != a.cols())
+            throw MuthExceptionInvalidOperation("trying to factorize a non-square matrix");
+        const size_t n = a.rows();
+        for (size_t i = 0; i < n; i++)
+        {
+            auto first = idx.begin() + ptr[i], last = idx.begin() + ptr[i + 1];
+            auto it = std::lower_bound(first, last, i);
+            if (it == last || *it != i)
+                throw MuthExceptionInvalidOperation("ILU(0) needs every diagonal entry stored");
+            diag[i] = it - idx.begin();
+        }
+
+        T amax = T(0);
+        for (const T &v : vals)
+            amax = std::max(amax, T(std::abs(v)));
+        const size_t none = std::numeric_limits<size_t>::max();
+        std::vector<size_t> position(n, none);
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t p = ptr[i]; p < ptr[i + 1]; p++)
+                position[idx[p]] = p;
+            for (size_t p = ptr[i]; p < diag[i]; p++)
+            {
+                const size_t k = idx[p];
+                vals[p] /= vals[diag[k]];
+                const T l_ik = vals[p];
+                for (size_t q = diag[k] + 1; q < ptr[k + 1]; q++)
+                    if (position[idx[q]] != none)
+                        vals[position[idx[q]]] -= l_ik * vals[q];
+            }
+            if (negligible(vals[diag[i]], amax, n))
+                throw MuthExceptionInvalidOperation("ILU(0) hit a zero pivot");
+            for (size_t p = ptr[i]; p < ptr[i + 1]; p++)
+                position[idx[p]] = none;
+        }
+    }
+
+    template <typename T>
+    void ILU0Preconditioner<T>::apply(const T *r, T *z, size_t n) const
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            T sum = r[i];
+            for (size_t p = ptr[i]; p < diag[i]; p++)
+                sum -= vals[p] * z[idx[p]];
+            z[i] = sum;
+        }
+        for (size_t i = n; i-- > 0;)
+        {
+            T sum = z[i];
+            for (size_t p = diag[i] + 1; p < ptr[i + 1]; p++)
+                sum -= vals[p] * z[idx[p]];
+            z[i] = sum / vals[diag[i]];
+        }
+    }
+
+    // Reports one iteration; returns true when the solver should stop.
+    template <typename T>
+    bool krylov_step(SolverResult<T> &result, T residual, T target, const SolverOptions<T> &options)
+    {
+        result.iterations++;
+        result.residual = residual;
+        result.converged = residual <= target;
+        if (options.callback && !options.callback(result.iterations, residual))
+            return true;
+        return result.converged;
+    }
+
+    // Preconditioned conjugate gradient, for symmetric positive-definite A
+    // and M.
+    template <typename T, typename Op, typename Pre>
+    SolverResult<T> cg(const Op &a, size_t n, const T *b, T *x, const Pre &pre, const SolverOptions<T> &options)
+    {
+        SolverResult<T> result;
+        std::vector<T> r(n), z(n), p(n), q(n);
+        krylov_apply(a, x, q.data());
+        for (size_t i = 0; i < n; i++)
+            r[i] = b[i] - q[i];
+        const T target = options.tolerance * krylov_norm(n, b);
+        result.residual = krylov_norm(n, r.data());
+        if ((result.converged = result.residual <= target))
+            return result;
+
+        pre.apply(r.data(), z.data(), n);
+        p = z;
+        T rz = krylov_dot(n, r.data(), z.data());
+        while (result.iterations < options.max_iterations)
+        {
+            krylov_apply(a, p.data(), q.data());
+            const T pq = krylov_dot(n, p.data(), q.data());
+            if (pq == T(0))
+                break;
+            const T alpha = rz / pq;
+            for (size_t i = 0; i < n; i++)
+            {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+            }
+            if (krylov_step(result, krylov_norm(n, r.data()), target, options))
+                break;
+            pre.apply(r.data(), z.data(), n);
+            const T rz_next = krylov_dot(n, r.data(), z.data());
+            const T beta = rz_next / rz;
+            rz = rz_next;
+            for (size_t i = 0; i < n; i++)
+                p[i] = z[i] + beta * p[i];
+        }
+        return result;
+    }
+
+    // Right-preconditioned BiCGSTAB for general nonsymmetric A.
+    template <typename T, typename Op, typename Pre>
+    SolverResult<T> bicgstab(const Op &a, size_t n, const T *b, T *x, const Pre &pre, const SolverOptions<T> &options)
+    {
+        SolverResult<T> result;
+        std::vector<T> r(n), r0(n), p(n, T(0)), v(n, T(0)), s(n), t(n), p_hat(n), s_hat(n);
+        krylov_apply(a, x, t.data());
+        for (size_t i = 0; i < n; i++)
+            r[i] = b[i] - t[i];
+        r0 = r;
+        const T target = options.tolerance * krylov_norm(n, b);
+        result.residual = krylov_norm(n, r.data());
+        if ((result.converged = result.residual <= target))
+            return result;
+
+        T rho = T(1), alpha = T(1), omega = T(1);
+        while (result.iterations < options.max_iterations)
+        {
+            const T rho_next = krylov_dot(n, r0.data(), r.data());
+            if (rho_next == T(0))
+                break;
+            const T beta = (rho_next / rho) * (alpha / omega);
+            rho = rho_next;
+            for (size_t i = 0; i < n; i++)
+                p[i] = r[i] + beta * (p[i] - omega * v[i]);
+            pre.apply(p.data(), p_hat.data(), n);
+            krylov_apply(a, p_hat.data(), v.data());
+            const T r0v = krylov_dot(n, r0.data(), v.data());
+            if (r0v == T(0))
+                break;
+            alpha = rho / r0v;
+            for (size_t i = 0; i < n; i++)
+                s[i] = r[i] - alpha * v[i];
+
+            const T s_norm = krylov_norm(n, s.data());
+            if (s_norm <= target)
+            {
+                for (size_t i = 0; i < n; i++)
+                    x[i] += alpha * p_hat[i];
+                krylov_step(result, s_norm, target, options);
+                break;
+            }
+
+            pre.apply(s.data(), s_hat.data(), n);
+            krylov_apply(a, s_hat.data(), t.data());
+            const T tt = krylov_dot(n, t.data(), t.data());
+            omega = tt == T(0) ? T(0) : krylov_dot(n, t.data(), s.data()) / tt;
+            for (size_t i = 0; i < n; i++)
+            {
+                x[i] += alpha * p_hat[i] + omega * s_hat[i];
+                r[i] = s[i] - omega * t[i];
+            }
+            if (krylov_step(result, krylov_norm(n, r.data()), target, options) || omega == T(0))
+                break;
+        }
+        return result;
+    }
+
+    // Right-preconditioned GMRES restarted every options.restart iterations.
+    // The Hessenberg least-squares problem is kept triangular with Givens
+    // rotations, so the residual norm is known without forming x.
+    template <typename T, typename Op, typename Pre>
+    SolverResult<T> gmres(const Op &a, size_t n, const T *b, T *x, const Pre &pre, const SolverOptions<T> &options)
+    {
+        SolverResult<T> result;
+        const size_t k_max = std::max<size_t>(1, std::min(options.restart, n));
+        std::vector<T> basis((k_max + 1) * n), h((k_max + 1) * k_max), cs(k_max), sn(k_max), g(k_max + 1), y(k_max);
+        std::vector<T> r(n), w(n), z(n);
+        const T target = options.tolerance * krylov_norm(n, b);
+
+        while (true)
+        {
+            krylov_apply(a, x, w.data());
+            for (size_t i = 0; i < n; i++)
+                r[i] = b[i] - w[i];
+            const T beta = krylov_norm(n, r.data());
+            result.residual = beta;
+            if ((result.converged = beta <= target) || result.iterations >= options.max_iterations)
+                return result;
+
+            std::fill(g.begin(), g.end(), T(0));
+            g[0] = beta;
+            for (size_t i = 0; i < n; i++)
+                basis[i] = r[i] / beta;
+
+            size_t k = 0;
+            bool stop = false;
+            while (k < k_max && result.iterations < options.max_iterations)
+            {
+                T *v_k = basis.data() + k * n;
+                pre.apply(v_k, z.data(), n);
+                krylov_apply(a, z.data(), w.data());
+                for (size_t i = 0; i <= k; i++)
+                {
+                    const T *v_i = basis.data() + i * n;
+                    const T h_ik = krylov_dot(n, w.data(), v_i);
+                    h[i * k_max + k] = h_ik;
+                    for (size_t e = 0; e < n; e++)
+                        w[e] -= h_ik * v_i[e];
+                }
+                const T h_next = krylov_norm(n, w.data());
+                if (h_next != T(0))
+                {
+                    T *v_next = basis.data() + (k + 1) * n;
+                    for (size_t e = 0; e < n; e++)
+                        v_next[e] = w[e] / h_next;
+                }
+
+                for (size_t i = 0; i < k; i++)
+                {
+                    const T upper = h[i * k_max + k], lower = h[(i + 1) * k_max + k];
+                    h[i * k_max + k] = cs[i] * upper + sn[i] * lower;
+                    h[(i + 1) * k_max + k] = -sn[i] * upper + cs[i] * lower;
+                }
+                const T diag = h[k * k_max + k];
+                const T radius = std::sqrt(diag * diag + h_next * h_next);
+                cs[k] = radius == T(0) ? T(1) : diag / radius;
+                sn[k] = radius == T(0) ? T(0) : h_next / radius;
+                h[k * k_max + k] = radius;
+                g[k + 1] = -sn[k] * g[k];
+                g[k] = cs[k] * g[k];
+                k++;
+
+                stop = krylov_step(result, std::abs(g[k]), target, options);
+                if (stop || h_next == T(0))
+                    break;
+            }
+
+            // x += M^-1 V y with H y = g
+            for (size_t i = k; i-- > 0;)
+            {
+                T sum = g[i];
+                for (size_t c = i + 1; c < k; c++)
+                    sum -= h[i * k_max + c] * y[c];
+                y[i] = h[i * k_max + i] == T(0) ? T(0) : sum / h[i * k_max + i];
+            }
+            std::fill(w.begin(), w.end(), T(0));
+            for (size_t i = 0; i < k; i++)
+            {
+                const T *v_i = basis.data() + i * n;
+                for (size_t e = 0; e < n; e++)
+                    w[e] += y[i] * v_i[e];
+            }
+            pre.apply(w.data(), z.data(), n);
+            for (size_t e = 0; e < n; e++)
+                x[e] += z[e];
+
+            if (stop)
+                return result;
+        }
+    }
+
+    // Convenience overloads on DynVector and Vector. An empty x starts from 0.
+    template <typename T, typename Op, typename Pre = IdentityPreconditioner<T>>
+    SolverResult<T> cg(const Op &a, const DynVector<T> &b, DynVector<T> &x, const SolverOptions<T> &options = {}, const Pre &pre = Pre())
+    {
+        krylov_check(a, b.size());
+        if (x.size() == 0)
+            x = DynVector<T>(b.size());
+        dyn_check_size(x.size(), b.size());
+        return cg(a, b.size(), b.elements, x.elements, pre, options);
+    }
+
+    template <typename T, size_t n, typename Op, typename Pre = IdentityPreconditioner<T>>
+    SolverResult<T> cg(const Op &a, const Vector<T, n> &b, Vector<T, n> &x, const SolverOptions<T> &options = {}, const Pre &pre = Pre())
+    {
+        krylov_check(a, n);
+        return cg(a, n, b.elements, x.elements, pre, options);
+    }
+
+    template <typename T, typename Op, typename Pre = IdentityPreconditioner<T>>
+    SolverResult<T> bicgstab(const Op &a, const DynVector<T> &b, DynVector<T> &x, const SolverOptions<T> &options = {}, const Pre &pre = Pre())
+    {
+        krylov_check(a, b.size());
+        if (x.size() == 0)
+            x = DynVector<T>(b.size());
+        dyn_check_size(x.size(), b.size());
+        return bicgstab(a, b.size(), b.elements, x.elements, pre, options);
+    }
+
+    template <typename T, size_t n, typename Op, typename Pre = IdentityPreconditioner<T>>
+    SolverResult<T> bicgstab(const Op &a, const Vector<T, n> &b, Vector<T, n> &x, const SolverOptions<T> &options = {}, const Pre &pre = Pre())
+    {
+        krylov_check(a, n);
+        return bicgstab(a, n, b.elements, x.elements, pre, options);
+    }
+
+    template <typename T, typename Op, typename Pre = IdentityPreconditioner<T>>
+    SolverResult<T> gmres(const Op &a, const DynVector<T> &b, DynVector<T> &x, const SolverOptions<T> &options = {}, const Pre &pre = Pre())
+    {
+        krylov_check(a, b.size());
+        if (x.size() == 0)
+            x = DynVector<T>(b.size());
+        dyn_check_size(x.size(), b.size());
+        return gmres(a, b.size(), b.elements, x.elements, pre, options);
+    }
+
+    template <typename T, size_t n, typename Op, typename Pre = IdentityPreconditioner<T>>
+    SolverResult<T> gmres(const Op &a, const Vector<T, n> &b, Vector<T, n> &x, const SolverOptions<T> &options = {}, const Pre &pre = Pre())
+    {
+        krylov_check(a, n);
+        return gmres(a, n, b.elements, x.elements, pre, options);
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
@@ -0,0 +1,306 @@
+#ifndef MUTH_LU_H
+#define MUTH_LU_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "ThreadPool.h"
+#include "Matrix.h"
+#include "DynMatrix.h"
+#include "View.h"
+
+namespace Muth
+{
+
+    // In-place LU factorization with partial pivoting of a row-major n x n
+    // block: afterwards a holds U on and above the diagonal and the multipliers
+    // of the unit lower L below it, with perm[i] the source row of row i.
+    // Columns that are zero below the current row are skipped, so for
+    // singular input a holds a row echelon form. Returns the numerical rank,
+    // the number of pivots above n eps times the largest element of a; sign
+    // receives the parity of the row swaps.
+    template <typename T>
+    size_t lu_factor(T *a, size_t n, size_t *perm, int &sign)
+    {
+        T amax = T(0);
+        for (size_t i = 0; i < n * n; i++)
+            amax = std::max(amax, T(std::abs(a[i])));
+        for (size_t i = 0; i < n; i++)
+            perm[i] = i;
+        sign = 1;
+
+        size_t p = 0, rank = 0;
+        for (size_t k = 0; k < n && p < n; k++)
+        {
+            size_t pivot = p;
+            T best = std::abs(a[p * n + k]);
+            for (size_t r = p + 1; r < n; r++)
+            {
+                const T candidate = std::abs(a[r * n + k]);
+                if (candidate > best)
+                {
+                    best = candidate;
+                    pivot = r;
+                }
+            }
+            if (best == T(0))
+                continue;
+            if (!negligible(best, amax, n))
+                rank++;
+            if (pivot != p)
+            {
+                std::swap_ranges(a + p * n, a + p * n + n, a + pivot * n);
+                std::swap(perm[p], perm[pivot]);
+                sign = -sign;
+            }
+
+            const T *pivot_row = a + p * n;
+            const T inv_pivot = T(1) / pivot_row[k];
+            parallel_for(p + 1, n, n - k, parallel_config().eliminate_min, [&](size_t lo, size_t hi) {
+                for (size_t r = lo; r < hi; r++)
+                {
+                    T *row = a + r * n;
+                    const T factor = row[k] * inv_pivot;
+                    row[k] = factor;
+                    for (size_t c = k + 1; c < n; c++)
+                        row[c] -= factor * pivot_row[c];
+                }
+            });
+            p++;
+        }
+        return rank;
+    }
+
+    // Solves L U x = P b for one right-hand side, given lu_factor output of a
+    // full-rank block. Works in scratch (n elements), so b and x may alias.
+    template <typename T>
+    void lu_solve(const T *lu, size_t n, const size_t *perm, const T *b, T *x, T *scratch)
+    {
+        for (size_t i = 0; i < n; i++)
+            scratch[i] = b[perm[i]];
+        for (size_t i = 1; i < n; i++)
+        {
+            const T *row = lu + i * n;
+            T sum = scratch[i];
+            for (size_t k = 0; k < i; k++)
+                sum -= row[k] * scratch[k];
+            scratch[i] = sum;
+        }
+        for (size_t i = n; i-- > 0;)
+        {
+            const T *row = lu + i * n;
+            T sum = scratch[i];
+            for (size_t k = i + 1; k < n; k++)
+                sum -= row[k] * scratch[k];
+            scratch[i] = sum / row[i];
+        }
+        std::copy_n(scratch, n, x);
+    }
+
+    template <typename T>
+    T lu_det(const T *lu, size_t n, size_t rank, int sign)
+    {
+        if (rank < n)
+            return T(0);
+        T ans = T(sign);
+        for (size_t i = 0; i < n; i++)
+            ans *= lu[i * n + i];
+        return ans;
+    }
+
+    // Factorization of a square Matrix, computed once in the constructor.
+    // det and rank cost O(n) afterwards, every solve O(n^2).
+    template <typename T, size_t n>
+    struct LU
+    {
+    private:
+        Matrix<T, n, n> lu;
+        std::array<size_t, n> perm;
+        int sign;
+        size_t rank_;
+
+    public:
+        LU(const Matrix<T, n, n> &mat);
+
+        T det() const { return lu_det(lu.elements, n, rank_, sign); }
+        size_t rank() const { return rank_; }
+        bool reversible() const { return rank_ == n; }
+
+        Vector<T, n> solve(const Vector<T, n> &b) const;
+        template <size_t k>
+        Matrix<T, n, k> solve(const Matrix<T, n, k> &b) const;
+        Matrix<T, n, n> inverse() const;
+
+        Matrix<T, n, n> lower() const;
+        Matrix<T, n, n> upper() const;
+        const std::array<size_t, n> &permutation() const { return perm; }
+    };
+
+    template <typename T, size_t n>
+    LU<T, n>::LU(const Matrix<T, n, n> &mat) : lu(mat)
+    {
+        rank_ = lu_factor(lu.elements, n, perm.data(), sign);
+    }
+
+    template <typename T, size_t n>
+    Vector<T, n> LU<T, n>::solve(const Vector<T, n> &b) const
+    {
+        if (!reversible())
+            throw MuthExceptionInvalidOperation("trying to solve a singular system");
+        Vector<T, n> x;
+        std::array<T, n> scratch;
+        lu_solve(lu.elements, n, perm.data(), b.elements, x.elements, scratch.data());
+        return x;
+    }
+
+    template <typename T, size_t n>
+    template <size_t k>
+    Matrix<T, n, k> LU<T, n>::solve(const Matrix<T, n, k> &b) const
+    {
+        if (!reversible())
+            throw MuthExceptionInvalidOperation("trying to solve a singular system");
+        Matrix<T, n, k> x;
+        std::array<T, n> column, scratch;
+        for (size_t c = 0; c < k; c++)
+        {
+            for (size_t r = 0; r < n; r++)
+                column[r] = b[r][c];
+            lu_solve(lu.elements, n, perm.data(), column.data(), column.data(), scratch.data());
+            for (size_t r = 0; r < n; r++)
+                x[r][c] = column[r];
+        }
+        return x;
+    }
+
+    template <typename T, size_t n>
+    Matrix<T, n, n> LU<T, n>::inverse() const
+    {
+        Matrix<T, n, n> identity;
+        for (size_t i = 0; i < n; i++)
+            identity[i][i] = T(1);
+        return solve(identity);
+    }
+
+    template <typename T, size_t n>
+    Matrix<T, n, n> LU<T, n>::lower() const
+    {
+        Matrix<T, n, n> l;
+        for (size_t r = 0; r < n; r++)
+        {
+            for (size_t c = 0; c < r; c++)
+                l[r][c] = lu[r][c];
+            l[r][r] = T(1);
+        }
+        return l;
+    }
+
+    template <typename T, size_t n>
+    Matrix<T, n, n> LU<T, n>::upper() const
+    {
+        Matrix<T, n, n> u;
+        for (size_t r = 0; r < n; r++)
+            for (size_t c = r; c < n; c++)
+                u[r][c] = lu[r][c];
+        return u;
+    }
+
+    // Same as LU for a square DynMatrix or a view of either layout; the
+    // operands of solve() may be views as well.
+    template <typename T>
+    struct DynLU
+    {
+    private:
+        DynMatrix<T> lu;
+        std::vector<size_t> perm;
+        int sign;
+        size_t rank_;
+
+    public:
+        DynLU(const MatrixView<const T> &mat) : lu(mat.clone()), perm(mat.rows()) { factor(); }
+        DynLU(const MatrixView<const T, Layout::ColMajor> &mat) : lu(mat.clone()), perm(mat.rows()) { factor(); }
+        // Views refuse temporaries; the factorization copies its input, so
+        // containers are taken directly and may be temporaries (DynLU(a * a)).
+        DynLU(const DynMatrix<T> &mat) : DynLU(MatrixView<const T>(mat)) {}
+
+        size_t size() const { return lu.rows(); }
+        T det() const { return lu_det(lu.elements, size(), rank_, sign); }
+        size_t rank() const { return rank_; }
+        bool reversible() const { return rank_ == size(); }
+
+        DynVector<T> solve(const VectorView<const T> &b) const;
+        DynMatrix<T> solve(const MatrixView<const T> &b) const;
+        DynVector<T> solve(const DynVector<T> &b) const { return solve(VectorView<const T>(b)); }
+        DynMatrix<T> solve(const DynMatrix<T> &b) const { return solve(MatrixView<const T>(b)); }
+        DynMatrix<T> inverse() const;
+
+        const std::vector<size_t> &permutation() const { return perm; }
+
+    private:
+        void factor();
+    };
+
+    template <typename T>
+    void DynLU<T>::factor()
+    {
+        if (lu.rows() != lu.cols())
+            throw MuthExceptionInvalidOperation("trying to factorize a non-square matrix");
+        rank_ = lu_factor(lu.elements, size(), perm.data(), sign);
+    }
+
+    template <typename T>
+    DynVector<T> DynLU<T>::solve(const VectorView<const T> &b) const
+    {
+        if (b.size() != size())
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        if (!reversible())
+            throw MuthExceptionInvalidOperation("trying to solve a singular system");
+        DynVector<T> x = b.clone();
+        std::vector<T> scratch(size());
+        lu_solve(lu.elements, size(), perm.data(), x.elements, x.elements, scratch.data());
+        return x;
+    }
+
+    template <typename T>
+    DynMatrix<T> DynLU<T>::solve(const MatrixView<const T> &b) const
+    {
+        if (b.rows() != size())
+            throw MuthExceptionInvalidOperation("matrix shapes do not match");
+        if (!reversible())
+            throw MuthExceptionInvalidOperation("trying to solve a singular system");
+        const size_t n = size();
+        DynMatrix<T> x(n, b.cols());
+        std::vector<T> column(n), scratch(n);
+        for (size_t c = 0; c < b.cols(); c++)
+        {
+            for (size_t r = 0; r < n; r++)
+                column[r] = b[r][c];
+            lu_solve(lu.elements, n, perm.data(), column.data(), column.data(), scratch.data());
+            for (size_t r = 0; r < n; r++)
+                x[r][c] = column[r];
+        }
+        return x;
+    }
+
+    template <typename T>
+    DynMatrix<T> DynLU<T>::inverse() const
+    {
+        DynMatrix<T> identity(size(), size());
+        for (size_t i = 0; i < size(); i++)
+            identity[i][i] = T(1);
+        return solve(identity);
+    }
+
+    static_assert(std::is_constructible<DynLU<double>, DynMatrix<double>>::value, "DynLU must accept a temporary matrix");
+    static_assert(std::is_same<decltype(std::declval<const DynLU<double> &>().solve(std::declval<DynVector<double>>())), DynVector<double>>::value &&
+                      std::is_same<decltype(std::declval<const DynLU<double> &>().solve(std::declval<DynMatrix<double>>())), DynMatrix<double>>::value,
+                  "DynLU::solve must accept temporaries");
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
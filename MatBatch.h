@@ -0,0 +1,361 @@
+#ifndef MUTH_MAT_BATCH_H
+#define MUTH_MAT_BATCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "ThreadPool.h"
+#include "Matrix.h"
+#include "VecBatch.h"
+
+// Matrices interleaved per block of the batch layout. 8 fills an AVX
+// register of floats; the kernels are plain loops, so any width works.
+#ifndef MUTH_BATCH_LANES
+#define MUTH_BATCH_LANES 8
+#endif
+
+namespace Muth
+{
+
+    constexpr size_t batch_lanes = MUTH_BATCH_LANES;
+
+    inline size_t batch_blocks(size_t count) { return (count + batch_lanes - 1) / batch_lanes; }
+
+    // One scalar of batch_lanes matrices. The closed-form det/adj helpers of
+    // Matrix.h are templates on the element type, so instantiating them on
+    // BatchLanes runs every scalar operation as a loop over the lanes, which
+    // the compiler turns into vector instructions.
+    template <typename T>
+    struct BatchLanes
+    {
+        T lane[batch_lanes];
+    };
+
+    template <typename T>
+    inline BatchLanes<T> operator+(const BatchLanes<T> &left, const BatchLanes<T> &right)
+    {
+        BatchLanes<T> result;
+        for (size_t l = 0; l < batch_lanes; l++)
+            result.lane[l] = left.lane[l] + right.lane[l];
+        return result;
+    }
+
+    template <typename T>
+    inline BatchLanes<T> operator-(const BatchLanes<T> &left, const BatchLanes<T> &right)
+    {
+        BatchLanes<T> result;
+        for (size_t l = 0; l < batch_lanes; l++)
+            result.lane[l] = left.lane[l] - right.lane[l];
+        return result;
+    }
+
+    template <typename T>
+    inline BatchLanes<T> operator*(const BatchLanes<T> &left, const BatchLanes<T> &right)
+    {
+        BatchLanes<T> result;
+        for (size_t l = 0; l < batch_lanes; l++)
+            result.lane[l] = left.lane[l] * right.lane[l];
+        return result;
+    }
+
+    template <typename T>
+    inline BatchLanes<T> operator-(const BatchLanes<T> &value)
+    {
+        BatchLanes<T> result;
+        for (size_t l = 0; l < batch_lanes; l++)
+            result.lane[l] = -value.lane[l];
+        return result;
+    }
+
+    // Kernels over the interleaved layout: matrices are grouped in blocks of
+    // batch_lanes, and entry e (row-major) of lane l in block b lives at
+    // a[(b * rows * cols + e) * batch_lanes + l]. Each block is contiguous
+    // and each entry is a short unit-stride run across matrices, so one
+    // vector instruction serves batch_lanes matrices. count is the number of
+    // matrices; storage covers batch_blocks(count) full blocks. Outputs may
+    // alias inputs. Blocks are split across the opt-in pool.
+
+    // c = a * b, matrix by matrix.
+    template <typename T, size_t n, size_t m, size_t w>
+    void batch_multiply(const T *a, const T *b, T *c, size_t count)
+    {
+        constexpr size_t L = batch_lanes;
+        parallel_for(0, batch_blocks(count), n * m * w * L, parallel_config().batch_min, [=](size_t lo, size_t hi) {
+            for (size_t blk = lo; blk < hi; blk++)
+            {
+                const T *a_blk = a + blk * n * m * L;
+                const T *b_blk = b + blk * m * w * L;
+                T tile[n * w * L];
+                for (size_t r = 0; r < n; r++)
+                {
+                    for (size_t col = 0; col < w; col++)
+                    {
+                        T *t = tile + (r * w + col) * L;
+                        for (size_t l = 0; l < L; l++)
+                            t[l] = a_blk[(r * m) * L + l] * b_blk[col * L + l];
+                        for (size_t k = 1; k < m; k++)
+                            for (size_t l = 0; l < L; l++)
+                                t[l] += a_blk[(r * m + k) * L + l] * b_blk[(k * w + col) * L + l];
+                    }
+                }
+                std::copy_n(tile, n * w * L, c + blk * n * w * L);
+            }
+        });
+    }
+
+    // out[i] = det(a_i) for n <= 4, using the closed forms of Matrix.h.
+    template <typename T, size_t n>
+    void batch_det(const T *a, T *out, size_t count)
+    {
+        static_assert(n >= 2 && n <= 4, "batched determinants are provided for sizes 2 to 4");
+        constexpr size_t L = batch_lanes;
+        parallel_for(0, batch_blocks(count), n * n * n * L, parallel_config().batch_min, [=](size_t lo, size_t hi) {
+            for (size_t blk = lo; blk < hi; blk++)
+            {
+                BatchLanes<T> mat[n * n];
+                for (size_t e = 0; e < n * n; e++)
+                    std::copy_n(a + (blk * n * n + e) * L, L, mat[e].lane);
+                BatchLanes<T> d;
+                if constexpr (n == 2)
+                    d = det2(mat);
+                else if constexpr (n == 3)
+                    d = det3(mat);
+                else
+                    d = det4(mat);
+                std::copy_n(d.lane, std::min(L, count - blk * L), out + blk * L);
+            }
+        });
+    }
+
+    // c_i = inverse(a_i) for n <= 4 through the adjugate. Returns false if
+    // any of the first count was singular (see singular_det); a zero
+    // determinant leaves a non-finite output, or a zero one for integers.
+    // Padding lanes stay zero.
+    template <typename T, size_t n>
+    bool batch_inverse(const T *a, T *c, size_t count)
+    {
+        static_assert(n >= 2 && n <= 4, "batched inverses are provided for sizes 2 to 4");
+        constexpr size_t L = batch_lanes;
+        std::atomic<bool> invertible{true};
+        parallel_for(0, batch_blocks(count), n * n * n * L, parallel_config().batch_min, [=, &invertible](size_t lo, size_t hi) {
+            bool all = true;
+            for (size_t blk = lo; blk < hi; blk++)
+            {
+                BatchLanes<T> mat[n * n], adj[n * n];
+                for (size_t e = 0; e < n * n; e++)
+                    std::copy_n(a + (blk * n * n + e) * L, L, mat[e].lane);
+                BatchLanes<T> d;
+                if constexpr (n == 2)
+                    d = adj2(mat, adj);
+                else if constexpr (n == 3)
+                    d = adj3(mat, adj);
+                else
+                    d = adj4(mat, adj);
+                const size_t used = std::min(L, count - blk * L);
+                for (size_t l = 0; l < used; l++)
+                {
+                    T norm = T(0);
+                    for (size_t r = 0; r < n; r++)
+                    {
+                        T sum = T(0);
+                        for (size_t col = 0; col < n; col++)
+                            sum += std::abs(mat[r * n + col].lane[l]);
+                        norm = std::max(norm, sum);
+                    }
+                    all &= !singular_det(d.lane[l], norm, n);
+                }
+                for (size_t l = 0; l < L; l++)
+                {
+                    if (l < used && (!std::is_integral<T>::value || d.lane[l] != T(0)))
+                        d.lane[l] = T(1) / d.lane[l];
+                    else
+                        d.lane[l] = T(0);
+                }
+                T *c_blk = c + blk * n * n * L;
+                for (size_t e = 0; e < n * n; e++)
+                    for (size_t l = 0; l < L; l++)
+                        c_blk[e * L + l] = adj[e].lane[l] * d.lane[l];
+            }
+            if (!all)
+                invertible = false;
+        });
+        return invertible;
+    }
+
+    // Batch of n x m matrices in the interleaved layout above. Converts from
+    // and to arrays of Matrix; the operations below resize their outputs
+    // like the VecBatch ones.
+    template <typename T, size_t n, size_t m>
+    struct MatBatch
+    {
+    public:
+        // batch_blocks(size()) blocks; lanes past size() are zero.
+        std::vector<T> elements;
+
+    private:
+        size_t count;
+
+    public:
+        MatBatch() : count(0) {}
+        explicit MatBatch(size_t count) : elements(batch_blocks(count) * n * m * batch_lanes), count(count) {}
+        MatBatch(const Matrix<T, n, m> *mats, size_t count);
+        MatBatch(const std::vector<Matrix<T, n, m>> &mats) : MatBatch(mats.data(), mats.size()) {}
+
+    public:
+        size_t size() const { return count; }
+        void resize(size_t new_count);
+
+        T &at(size_t idx, size_t r, size_t c) { return elements[((idx / batch_lanes) * n * m + r * m + c) * batch_lanes + idx % batch_lanes]; }
+        const T &at(size_t idx, size_t r, size_t c) const { return elements[((idx / batch_lanes) * n * m + r * m + c) * batch_lanes + idx % batch_lanes]; }
+
+        Matrix<T, n, m> get(size_t idx) const;
+        void set(size_t idx, const Matrix<T, n, m> &mat);
+
+        void to_aos(Matrix<T, n, m> *out) const;
+        std::vector<Matrix<T, n, m>> to_aos() const;
+    };
+
+    template <typename T>
+    using Mat2Batch = MatBatch<T, 2ULL, 2ULL>;
+    template <typename T>
+    using Mat3Batch = MatBatch<T, 3ULL, 3ULL>;
+    template <typename T>
+    using Mat4Batch = MatBatch<T, 4ULL, 4ULL>;
+
+    template <typename T, size_t n, size_t m>
+    MatBatch<T, n, m>::MatBatch(const Matrix<T, n, m> *mats, size_t count) : MatBatch(count)
+    {
+        for (size_t i = 0; i < count; i++)
+            this->set(i, mats[i]);
+    }
+
+    // Blocks do not depend on the count, so existing matrices stay in place;
+    // lanes freed by shrinking are cleared to keep the padding zero.
+    template <typename T, size_t n, size_t m>
+    void MatBatch<T, n, m>::resize(size_t new_count)
+    {
+        for (size_t i = new_count; i < std::min(count, batch_blocks(new_count) * batch_lanes); i++)
+            this->set(i, Matrix<T, n, m>());
+        elements.resize(batch_blocks(new_count) * n * m * batch_lanes);
+        count = new_count;
+    }
+
+    template <typename T, size_t n, size_t m>
+    Matrix<T, n, m> MatBatch<T, n, m>::get(size_t idx) const
+    {
+        Matrix<T, n, m> result;
+        const T *src = elements.data() + (idx / batch_lanes) * n * m * batch_lanes + idx % batch_lanes;
+        for (size_t e = 0; e < n * m; e++)
+            result.elements[e] = src[e * batch_lanes];
+        return result;
+    }
+
+    template <typename T, size_t n, size_t m>
+    void MatBatch<T, n, m>::set(size_t idx, const Matrix<T, n, m> &mat)
+    {
+        T *dst = elements.data() + (idx / batch_lanes) * n * m * batch_lanes + idx % batch_lanes;
+        for (size_t e = 0; e < n * m; e++)
+            dst[e * batch_lanes] = mat.elements[e];
+    }
+
+    template <typename T, size_t n, size_t m>
+    void MatBatch<T, n, m>::to_aos(Matrix<T, n, m> *out) const
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = this->get(i);
+    }
+
+    template <typename T, size_t n, size_t m>
+    std::vector<Matrix<T, n, m>> MatBatch<T, n, m>::to_aos() const
+    {
+        std::vector<Matrix<T, n, m>> result(count);
+        to_aos(result.data());
+        return result;
+    }
+
+    template <typename T, size_t n, size_t m, size_t w>
+    void multiply(const MatBatch<T, n, m> &left, const MatBatch<T, m, w> &right, MatBatch<T, n, w> &out)
+    {
+        batch_check_size(left, right);
+        out.resize(left.size());
+        batch_multiply<T, n, m, w>(left.elements.data(), right.elements.data(), out.elements.data(), left.size());
+    }
+
+    template <typename T, size_t n>
+    void det(const MatBatch<T, n, n> &mats, std::vector<T> &out)
+    {
+        out.resize(mats.size());
+        batch_det<T, n>(mats.elements.data(), out.data(), mats.size());
+    }
+
+    template <typename T, size_t n>
+    void inverse(const MatBatch<T, n, n> &mats, MatBatch<T, n, n> &out)
+    {
+        out.resize(mats.size());
+        if (!batch_inverse<T, n>(mats.elements.data(), out.elements.data(), mats.size()))
+            throw MuthExceptionInvalidOperation("trying to invert a singular matrix");
+    }
+
+    // out_i = mats_i * vecs_i.
+    template <typename T>
+    void transform(const Mat3Batch<T> &mats, const Vec3Batch<T> &vecs, Vec3Batch<T> &out)
+    {
+        batch_check_size(mats, vecs);
+        const size_t count = vecs.size();
+        out.resize(count);
+        constexpr size_t L = batch_lanes;
+        const T *a = mats.elements.data();
+        const T *vx = vecs.x.data(), *vy = vecs.y.data(), *vz = vecs.z.data();
+        T *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data();
+        parallel_for(0, batch_blocks(count), 9 * L, parallel_config().batch_min, [=](size_t lo, size_t hi) {
+            for (size_t blk = lo; blk < hi; blk++)
+            {
+                const T *m = a + blk * 9 * L;
+                const size_t base = blk * L, used = std::min(L, count - base);
+                for (size_t l = 0; l < used; l++)
+                {
+                    const T px = vx[base + l], py = vy[base + l], pz = vz[base + l];
+                    ox[base + l] = m[0 * L + l] * px + m[1 * L + l] * py + m[2 * L + l] * pz;
+                    oy[base + l] = m[3 * L + l] * px + m[4 * L + l] * py + m[5 * L + l] * pz;
+                    oz[base + l] = m[6 * L + l] * px + m[7 * L + l] * py + m[8 * L + l] * pz;
+                }
+            }
+        });
+    }
+
+    // Applies mats_i to (x, y, z, 1) and divides by the resulting w.
+    template <typename T>
+    void transform(const Mat4Batch<T> &mats, const Vec3Batch<T> &vecs, Vec3Batch<T> &out)
+    {
+        batch_check_size(mats, vecs);
+        const size_t count = vecs.size();
+        out.resize(count);
+        constexpr size_t L = batch_lanes;
+        const T *a = mats.elements.data();
+        const T *vx = vecs.x.data(), *vy = vecs.y.data(), *vz = vecs.z.data();
+        T *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data();
+        parallel_for(0, batch_blocks(count), 16 * L, parallel_config().batch_min, [=](size_t lo, size_t hi) {
+            for (size_t blk = lo; blk < hi; blk++)
+            {
+                const T *m = a + blk * 16 * L;
+                const size_t base = blk * L, used = std::min(L, count - base);
+                for (size_t l = 0; l < used; l++)
+                {
+                    const T px = vx[base + l], py = vy[base + l], pz = vz[base + l];
+                    const T inv_w = T(1) / (m[12 * L + l] * px + m[13 * L + l] * py + m[14 * L + l] * pz + m[15 * L + l]);
+                    ox[base + l] = (m[0 * L + l] * px + m[1 * L + l] * py + m[2 * L + l] * pz + m[3 * L + l]) * inv_w;
+                    oy[base + l] = (m[4 * L + l] * px + m[5 * L + l] * py + m[6 * L + l] * pz + m[7 * L + l]) * inv_w;
+                    oz[base + l] = (m[8 * L + l] * px + m[9 * L + l] * py + m[10 * L + l] * pz + m[11 * L + l]) * inv_w;
+                }
+            }
+        });
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
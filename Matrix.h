@@ -1,124 +1,276 @@
 #ifndef MUTH_MATRIX_H
 #define MUTH_MATRIX_H
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 
 #include "NumTool.h"
 #include "MuthException.h"
+#include "Expression.h"
+#include "Gemm.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include "Storage.h"
+#include "Transpose.h"
 #include "Vector.h"
 
 namespace Muth
 {
 
     template <typename T, size_t n, size_t m>
-    struct Matrix
+    struct Matrix : public StorageSelector<T, n * m>::type
     {
     public:
-        T *elements;
+        using Storage = typename StorageSelector<T, n * m>::type;
+        using Storage::elements;
 
     public:
-        Matrix();
-        Matrix(const Matrix<T, n, m> &src);
-        Matrix(const T *values);
-        Matrix(const std::initializer_list<T> &values);
-        Matrix(Matrix<T, n, m> &&r_value);
-        ~Matrix();
-
-        Matrix<T, n, m> &operator=(Matrix<T, n, m> &&other);
-        Matrix<T, n, m> &operator+=(Matrix<T, n, m> &&other);
-        Matrix<T, n, m> &operator-=(Matrix<T, n, m> &&other);
-        Matrix<T, n, m> &operator*=(T lambda);
-        Matrix<T, n, m> &operator/=(T lambda);
-
-        inline T *operator[](const size_t &row) const;
-        inline T &get_ref(const size_t &row, const size_t &col) const;
+        constexpr Matrix();
+        Matrix(const Matrix<T, n, m> &src) = default;
+        constexpr Matrix(const T *values);
+        constexpr Matrix(const std::initializer_list<T> &values);
+        Matrix(Matrix<T, n, m> &&r_value) = default;
+        template <typename E, typename = EnableIfNodeOf<E, Matrix<T, n, m>>>
+        constexpr Matrix(const E &expr);
+        ~Matrix() = default;
+
+        Matrix<T, n, m> &operator=(const Matrix<T, n, m> &other) = default;
+        Matrix<T, n, m> &operator=(Matrix<T, n, m> &&other) = default;
+        template <typename E, typename = EnableIfNodeOf<E, Matrix<T, n, m>>>
+        constexpr Matrix<T, n, m> &operator=(const E &expr);
+        template <typename E, typename = EnableIfExprOf<E, Matrix<T, n, m>>>
+        constexpr Matrix<T, n, m> &operator+=(const E &other);
+        template <typename E, typename = EnableIfExprOf<E, Matrix<T, n, m>>>
+        constexpr Matrix<T, n, m> &operator-=(const E &other);
+        constexpr Matrix<T, n, m> &operator*=(T lambda);
+        constexpr Matrix<T, n, m> &operator/=(T lambda);
+
+        constexpr T *operator[](const size_t &row);
+        constexpr const T *operator[](const size_t &row) const;
+        constexpr T &get_ref(const size_t &row, const size_t &col);
+        constexpr const T &get_ref(const size_t &row, const size_t &col) const;
 
         std::string to_string(const std::string &separator = " ", const std::string &end_row = "") const;
         operator std::string() const;
 
-        operator T *() const;
+        operator T *();
+        operator const T *() const;
 
-        inline Matrix<T, m, n> transform() const;
+        constexpr Matrix<T, m, n> transform() const;
+        // Square matrices only.
+        constexpr void transform_in_place();
 
-        inline void row_multiply(const size_t &r, const T &k);
-        inline void row_swap(const size_t &r1, const size_t &r2);
-        inline void row_add_to(const size_t &added_r, const size_t &add_r, T k);
+        constexpr void row_multiply(const size_t &r, const T &k);
+        constexpr void row_swap(const size_t &r1, const size_t &r2);
+        constexpr void row_add_to(const size_t &added_r, const size_t &add_r, T k);
 
         void gaussian_eliminate();
-        T det() const;
+        constexpr T det() const;
 
         bool reversible() const;
+        Matrix<T, n, m> inverse() const;
+        Matrix<T, n, m> affine_inverse() const;
     };
 
-    template <typename T, size_t n, size_t m>
-    Matrix<T, n, m>::Matrix()
+    // Closed-form determinants of row-major 2x2, 3x3 and 4x4 blocks. The 4x4
+    // form expands along the top two rows by their 2x2 minors.
+    template <typename T>
+    constexpr T det2(const T *a)
     {
-        elements = new T[n * m]{};
+        return a[0] * a[3] - a[1] * a[2];
     }
 
-    template <typename T, size_t n, size_t m>
-    Matrix<T, n, m>::Matrix(const Matrix<T, n, m> &src)
+    template <typename T>
+    constexpr T det3(const T *a)
     {
-        elements = new T[n * m]{};
-        memcpy(elements, src.elements, n * m * sizeof(T));
+        return a[0] * (a[4] * a[8] - a[5] * a[7]) -
+               a[1] * (a[3] * a[8] - a[5] * a[6]) +
+               a[2] * (a[3] * a[7] - a[4] * a[6]);
     }
 
+    template <typename T>
+    constexpr T det4(const T *a)
+    {
+        const T s0 = a[0] * a[5] - a[1] * a[4];
+        const T s1 = a[0] * a[6] - a[2] * a[4];
+        const T s2 = a[0] * a[7] - a[3] * a[4];
+        const T s3 = a[1] * a[6] - a[2] * a[5];
+        const T s4 = a[1] * a[7] - a[3] * a[5];
+        const T s5 = a[2] * a[7] - a[3] * a[6];
+        const T c0 = a[8] * a[13] - a[9] * a[12];
+        const T c1 = a[8] * a[14] - a[10] * a[12];
+        const T c2 = a[8] * a[15] - a[11] * a[12];
+        const T c3 = a[9] * a[14] - a[10] * a[13];
+        const T c4 = a[9] * a[15] - a[11] * a[13];
+        const T c5 = a[10] * a[15] - a[11] * a[14];
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    // Adjugates (transposed cofactor matrices) of the same blocks, written to
+    // out; each returns the determinant, so out / det is the inverse.
+    template <typename T>
+    constexpr T adj2(const T *a, T *out)
+    {
+        out[0] = a[3];
+        out[1] = -a[1];
+        out[2] = -a[2];
+        out[3] = a[0];
+        return a[0] * a[3] - a[1] * a[2];
+    }
+
+    template <typename T>
+    constexpr T adj3(const T *a, T *out)
+    {
+        out[0] = a[4] * a[8] - a[5] * a[7];
+        out[1] = a[2] * a[7] - a[1] * a[8];
+        out[2] = a[1] * a[5] - a[2] * a[4];
+        out[3] = a[5] * a[6] - a[3] * a[8];
+        out[4] = a[0] * a[8] - a[2] * a[6];
+        out[5] = a[2] * a[3] - a[0] * a[5];
+        out[6] = a[3] * a[7] - a[4] * a[6];
+        out[7] = a[1] * a[6] - a[0] * a[7];
+        out[8] = a[0] * a[4] - a[1] * a[3];
+        return a[0] * out[0] + a[1] * out[3] + a[2] * out[6];
+    }
+
+    template <typename T>
+    constexpr T adj4(const T *a, T *out)
+    {
+        const T s0 = a[0] * a[5] - a[1] * a[4];
+        const T s1 = a[0] * a[6] - a[2] * a[4];
+        const T s2 = a[0] * a[7] - a[3] * a[4];
+        const T s3 = a[1] * a[6] - a[2] * a[5];
+        const T s4 = a[1] * a[7] - a[3] * a[5];
+        const T s5 = a[2] * a[7] - a[3] * a[6];
+        const T c0 = a[8] * a[13] - a[9] * a[12];
+        const T c1 = a[8] * a[14] - a[10] * a[12];
+        const T c2 = a[8] * a[15] - a[11] * a[12];
+        const T c3 = a[9] * a[14] - a[10] * a[13];
+        const T c4 = a[9] * a[15] - a[11] * a[13];
+        const T c5 = a[10] * a[15] - a[11] * a[14];
+        out[0] = a[5] * c5 - a[6] * c4 + a[7] * c3;
+        out[1] = -a[1] * c5 + a[2] * c4 - a[3] * c3;
+        out[2] = a[13] * s5 - a[14] * s4 + a[15] * s3;
+        out[3] = -a[9] * s5 + a[10] * s4 - a[11] * s3;
+        out[4] = -a[4] * c5 + a[6] * c2 - a[7] * c1;
+        out[5] = a[0] * c5 - a[2] * c2 + a[3] * c1;
+        out[6] = -a[12] * s5 + a[14] * s2 - a[15] * s1;
+        out[7] = a[8] * s5 - a[10] * s2 + a[11] * s1;
+        out[8] = a[4] * c4 - a[5] * c2 + a[7] * c0;
+        out[9] = -a[0] * c4 + a[1] * c2 - a[3] * c0;
+        out[10] = a[12] * s4 - a[13] * s2 + a[15] * s0;
+        out[11] = -a[8] * s4 + a[9] * s2 - a[11] * s0;
+        out[12] = -a[4] * c3 + a[5] * c1 - a[6] * c0;
+        out[13] = a[0] * c3 - a[1] * c1 + a[2] * c0;
+        out[14] = -a[12] * s3 + a[13] * s1 - a[14] * s0;
+        out[15] = a[8] * s3 - a[9] * s1 + a[10] * s0;
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    // Largest absolute row sum of a row-major k x k block; |det| is at most
+    // its k-th power.
+    template <typename T>
+    T norm_inf(const T *a, size_t k)
+    {
+        T norm = T(0);
+        for (size_t r = 0; r < k; r++)
+        {
+            T sum = T(0);
+            for (size_t c = 0; c < k; c++)
+                sum += std::abs(a[r * k + c]);
+            norm = std::max(norm, sum);
+        }
+        return norm;
+    }
+
+    // Whether determinant d of a k x k block with infinity norm `norm` counts
+    // as singular: |d| / norm^k within k eps, so the test does not depend on
+    // the scale of the matrix. Integers compare exactly.
+    template <typename T>
+    bool singular_det(T d, T norm, size_t k)
+    {
+        if constexpr (std::is_integral<T>::value)
+            return d == T(0);
+        else
+        {
+            if (d == T(0))
+                return true;
+            T ratio = std::abs(d);
+            for (size_t i = 0; i < k; i++)
+                ratio /= norm;
+            return negligible(ratio, T(1), k);
+        }
+    }
+
+    template <typename T, size_t n, size_t m>
+    struct ExprTraits<Matrix<T, n, m>>
+    {
+        static constexpr bool is_expr = true;
+        static constexpr bool leaf = true;
+        using value_type = T;
+        using result_type = Matrix<T, n, m>;
+        static constexpr size_t size = n * m;
+        static constexpr const T &at(const Matrix<T, n, m> &mat, size_t i) { return mat.elements[i]; }
+    };
+
     template <typename T, size_t n, size_t m>
-    Matrix<T, n, m>::Matrix(const T *values)
+    constexpr Matrix<T, n, m>::Matrix() : Storage()
     {
-        elements = new T[n * m]{};
-        memcpy(elements, values, n * m * sizeof(T));
     }
 
     template <typename T, size_t n, size_t m>
-    inline Matrix<T, n, m>::Matrix(const std::initializer_list<T> &values)
+    constexpr Matrix<T, n, m>::Matrix(const T *values) : Storage()
     {
-        elements = new T[n * m]{};
-        std::copy(values.begin(), values.end(), elements);
+        for (size_t i = 0; i < n * m; i++)
+            elements[i] = values[i];
     }
 
     template <typename T, size_t n, size_t m>
-    Matrix<T, n, m>::Matrix(Matrix<T, n, m> &&r_value)
+    constexpr Matrix<T, n, m>::Matrix(const std::initializer_list<T> &values) : Storage()
     {
-        elements = r_value.elements;
-        r_value.elements = nullptr;
+        const T *src = values.begin();
+        for (size_t i = 0; i < n * m && i < values.size(); i++)
+            elements[i] = src[i];
     }
 
     template <typename T, size_t n, size_t m>
-    Matrix<T, n, m>::~Matrix()
+    template <typename E, typename>
+    constexpr Matrix<T, n, m>::Matrix(const E &expr) : Storage()
     {
-        delete[] elements;
+        for (size_t i = 0; i < n * m; i++)
+            elements[i] = ExprTraits<E>::at(expr, i);
     }
 
     template <typename T, size_t n, size_t m>
-    Matrix<T, n, m> &Matrix<T, n, m>::operator=(Matrix<T, n, m> &&other)
+    template <typename E, typename>
+    constexpr Matrix<T, n, m> &Matrix<T, n, m>::operator=(const E &expr)
     {
-        elements = other.elements;
-        other.elements = nullptr;
+        for (size_t i = 0; i < n * m; i++)
+            elements[i] = ExprTraits<E>::at(expr, i);
         return *this;
     }
 
     template <typename T, size_t n, size_t m>
-    inline Matrix<T, n, m> &Matrix<T, n, m>::operator+=(Matrix<T, n, m> &&other)
+    template <typename E, typename>
+    constexpr Matrix<T, n, m> &Matrix<T, n, m>::operator+=(const E &other)
     {
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < m; c++)
-                (*this)[r][c] += other[r][c];
+        for (size_t i = 0; i < n * m; i++)
+            elements[i] += ExprTraits<E>::at(other, i);
         return *this;
     }
 
     template <typename T, size_t n, size_t m>
-    inline Matrix<T, n, m> &Matrix<T, n, m>::operator-=(Matrix<T, n, m> &&other)
+    template <typename E, typename>
+    constexpr Matrix<T, n, m> &Matrix<T, n, m>::operator-=(const E &other)
     {
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < m; c++)
-                (*this)[r][c] -= other[r][c];
+        for (size_t i = 0; i < n * m; i++)
+            elements[i] -= ExprTraits<E>::at(other, i);
         return *this;
     }
 
     template <typename T, size_t n, size_t m>
-    inline Matrix<T, n, m> &Matrix<T, n, m>::operator*=(T lambda)
+    constexpr Matrix<T, n, m> &Matrix<T, n, m>::operator*=(T lambda)
     {
         for (size_t r = 0; r < n; r++)
             for (size_t c = 0; c < m; c++)
@@ -127,7 +279,7 @@ namespace Muth
     }
 
     template <typename T, size_t n, size_t m>
-    inline Matrix<T, n, m> &Matrix<T, n, m>::operator/=(T lambda)
+    constexpr Matrix<T, n, m> &Matrix<T, n, m>::operator/=(T lambda)
     {
         for (size_t r = 0; r < n; r++)
             for (size_t c = 0; c < m; c++)
@@ -136,13 +288,28 @@ namespace Muth
     }
 
     template <typename T, size_t n, size_t m>
-    inline T *Matrix<T, n, m>::operator[](const size_t &row) const
+    constexpr T *Matrix<T, n, m>::operator[](const size_t &row)
+    {
+        return elements + (row * m);
+    }
+
+    template <typename T, size_t n, size_t m>
+    constexpr const T *Matrix<T, n, m>::operator[](const size_t &row) const
     {
         return elements + (row * m);
     }
 
     template <typename T, size_t n, size_t m>
-    inline T &Matrix<T, n, m>::get_ref(const size_t &row, const size_t &col) const
+    constexpr T &Matrix<T, n, m>::get_ref(const size_t &row, const size_t &col)
+    {
+        if (row < n && col < m)
+            return elements[row * m + col];
+        else
+            throw MuthOutOfRangeException("matrix index out of range");
+    }
+
+    template <typename T, size_t n, size_t m>
+    constexpr const T &Matrix<T, n, m>::get_ref(const size_t &row, const size_t &col) const
     {
         if (row < n && col < m)
             return elements[row * m + col];
@@ -172,23 +339,52 @@ namespace Muth
     }
 
     template <typename T, size_t n, size_t m>
-    Matrix<T, n, m>::operator T *() const
+    Matrix<T, n, m>::operator T *()
+    {
+        return elements;
+    }
+
+    template <typename T, size_t n, size_t m>
+    Matrix<T, n, m>::operator const T *() const
     {
         return elements;
     }
 
     template <typename T, size_t n, size_t m>
-    inline Matrix<T, m, n> Matrix<T, n, m>::transform() const
+    constexpr Matrix<T, m, n> Matrix<T, n, m>::transform() const
     {
         Matrix<T, m, n> t;
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < m; c++)
-                t[c][r] = elements[r][c];
-        return std::move(t);
+        if (is_constant_evaluated())
+        {
+            for (size_t r = 0; r < n; r++)
+                for (size_t c = 0; c < m; c++)
+                    t[c][r] = (*this)[r][c];
+        }
+        else
+            transpose(n, m, elements, m, t.elements, n);
+        return t;
+    }
+
+    template <typename T, size_t n, size_t m>
+    constexpr void Matrix<T, n, m>::transform_in_place()
+    {
+        static_assert(n == m, "in-place transpose needs a square matrix");
+        if (is_constant_evaluated())
+        {
+            for (size_t r = 0; r < n; r++)
+                for (size_t c = r + 1; c < n; c++)
+                {
+                    const T tmp = elements[r * n + c];
+                    elements[r * n + c] = elements[c * n + r];
+                    elements[c * n + r] = tmp;
+                }
+        }
+        else
+            transpose_in_place(n, elements, n);
     }
 
     template <typename T, size_t n, size_t m>
-    inline void Matrix<T, n, m>::row_multiply(const size_t &r, const T &k)
+    constexpr void Matrix<T, n, m>::row_multiply(const size_t &r, const T &k)
     {
         T *row = elements + r * m;
         for (size_t i = 0; i < m; i++)
@@ -196,14 +392,18 @@ namespace Muth
     }
 
     template <typename T, size_t n, size_t m>
-    inline void Matrix<T, n, m>::row_swap(const size_t &r1, const size_t &r2)
+    constexpr void Matrix<T, n, m>::row_swap(const size_t &r1, const size_t &r2)
     {
         for (size_t i = 0; i < m; i++)
-            std::swap(elements[r1 * m + i], elements[r2 * m + i]);
+        {
+            T tmp = elements[r1 * m + i];
+            elements[r1 * m + i] = elements[r2 * m + i];
+            elements[r2 * m + i] = tmp;
+        }
     }
 
     template <typename T, size_t n, size_t m>
-    inline void Matrix<T, n, m>::row_add_to(const size_t &added_r, const size_t &add_r, T k)
+    constexpr void Matrix<T, n, m>::row_add_to(const size_t &added_r, const size_t &add_r, T k)
     {
         for (size_t i = 0; i < m; i++)
             elements[added_r * m + i] += elements[add_r * m + i] * k;
@@ -212,33 +412,49 @@ namespace Muth
     template <typename T, size_t n, size_t m>
     void Matrix<T, n, m>::gaussian_eliminate()
     {
-        for (int i = 0; i < m; i++)
+        T amax = T(0);
+        for (size_t i = 0; i < n * m; i++)
+            amax = std::max(amax, T(std::abs(elements[i])));
+        for (size_t i = 0; i < m && i < n; i++)
         {
-            int nonzero = i;
+            size_t nonzero = i;
             for (nonzero = i; nonzero < n; nonzero++)
-                if (Muth::nonzero(elements[nonzero * m + i]))
+                if (!negligible(elements[nonzero * m + i], amax, std::max(n, m)))
                     break;
             if (nonzero >= n)
-            {
-                i++;
                 continue;
-            }
             if (nonzero != i)
                 row_swap(i, nonzero);
-            for (size_t r = i + 1; r < n; r++)
-            {
-                row_add_to(r, i, -elements[r * m + i] / elements[i * m + i]);
-            }
+            parallel_for(i + 1, n, m, parallel_config().eliminate_min, [&](size_t lo, size_t hi) {
+                for (size_t r = lo; r < hi; r++)
+                    row_add_to(r, i, -elements[r * m + i] / elements[i * m + i]);
+            });
         }
     }
 
     template <typename T, size_t n, size_t m>
-    T Matrix<T, n, m>::det() const
+    constexpr T Matrix<T, n, m>::det() const
     {
         if (n != m)
         {
             throw MuthExceptionInvalidOperation("trying to calculate determinant of a non-square matrix");
         }
+        else if constexpr (n == 1 && m == 1)
+        {
+            return elements[0];
+        }
+        else if constexpr (n == 2 && m == 2)
+        {
+            return det2(elements);
+        }
+        else if constexpr (n == 3 && m == 3)
+        {
+            return det3(elements);
+        }
+        else if constexpr (n == 4 && m == 4)
+        {
+            return det4(elements);
+        }
         else
         {
             Matrix<T, n, m> tmp(*this);
@@ -253,110 +469,184 @@ namespace Muth
     template <typename T, size_t n, size_t m>
     inline bool Matrix<T, n, m>::reversible() const
     {
-        if (n != m)
+        if constexpr (n != m)
             return false;
-
-        Matrix<T, n, m> tmp(*this);
-        tmp.gaussian_eliminate();
-        return nonzero(tmp[n * m - 1]);
+        else if constexpr (n <= 4)
+            return !singular_det(det(), norm_inf(elements, n), n);
+        else
+        {
+            T amax = T(0);
+            for (size_t i = 0; i < n * m; i++)
+                amax = std::max(amax, T(std::abs(elements[i])));
+            Matrix<T, n, m> tmp(*this);
+            tmp.gaussian_eliminate();
+            for (size_t i = 0; i < n; i++)
+                if (negligible(tmp[i][i], amax, n))
+                    return false;
+            return true;
+        }
     }
 
+    // Closed-form adjugate inverse up to 4x4, Gauss-Jordan with partial
+    // pivoting above that. Throws if the matrix is singular.
     template <typename T, size_t n, size_t m>
-    std::ostream &operator<<(std::ostream &out, const Matrix<T, n, m> &mat)
+    Matrix<T, n, m> Matrix<T, n, m>::inverse() const
     {
-        return out << mat.to_string();
+        static_assert(n == m, "trying to invert a non-square matrix");
+        Matrix<T, n, m> result;
+        if constexpr (n <= 4)
+        {
+            T d = elements[0];
+            if constexpr (n == 1)
+                result.elements[0] = T(1);
+            else if constexpr (n == 2)
+                d = adj2(elements, result.elements);
+            else if constexpr (n == 3)
+                d = adj3(elements, result.elements);
+            else
+                d = adj4(elements, result.elements);
+            if (singular_det(d, norm_inf(elements, n), n))
+                throw MuthExceptionInvalidOperation("trying to invert a singular matrix");
+            result *= T(1) / d;
+            return result;
+        }
+        else
+        {
+            T amax = T(0);
+            for (size_t i = 0; i < n * m; i++)
+                amax = std::max(amax, T(std::abs(elements[i])));
+            Matrix<T, n, m> tmp(*this);
+            for (size_t i = 0; i < n; i++)
+                result[i][i] = T(1);
+            for (size_t k = 0; k < n; k++)
+            {
+                size_t pivot = k;
+                for (size_t r = k + 1; r < n; r++)
+                    if (std::abs(tmp[r][k]) > std::abs(tmp[pivot][k]))
+                        pivot = r;
+                if (negligible(tmp[pivot][k], amax, n))
+                    throw MuthExceptionInvalidOperation("trying to invert a singular matrix");
+                if (pivot != k)
+                {
+                    tmp.row_swap(k, pivot);
+                    result.row_swap(k, pivot);
+                }
+                const T inv_pivot = T(1) / tmp[k][k];
+                tmp.row_multiply(k, inv_pivot);
+                result.row_multiply(k, inv_pivot);
+                for (size_t r = 0; r < n; r++)
+                {
+                    if (r == k)
+                        continue;
+                    const T factor = -tmp[r][k];
+                    tmp.row_add_to(r, k, factor);
+                    result.row_add_to(r, k, factor);
+                }
+            }
+            return result;
+        }
     }
 
+    // Inverse of a homogeneous affine transform [A t; 0 1] (Mat3 in 2D, Mat4
+    // in 3D): [A^-1, -A^-1 t; 0 1]. The last row is assumed, not checked.
     template <typename T, size_t n, size_t m>
-    Matrix<T, n, m> &operator-(Matrix<T, n, m> &mat)
+    Matrix<T, n, m> Matrix<T, n, m>::affine_inverse() const
     {
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < m; c++)
-                mat[r][c] = -mat[r][c];
-        return mat;
-    }
+        static_assert(n == m && (n == 3 || n == 4), "affine inverse needs a Mat3 or Mat4");
+        constexpr size_t k = n - 1;
+        T linear[k * k] = {};
+        T inv[k * k] = {};
+        for (size_t r = 0; r < k; r++)
+            for (size_t c = 0; c < k; c++)
+                linear[r * k + c] = elements[r * n + c];
+        T d = T(0);
+        if constexpr (k == 2)
+            d = adj2(linear, inv);
+        else
+            d = adj3(linear, inv);
+        if (singular_det(d, norm_inf(linear, k), k))
+            throw MuthExceptionInvalidOperation("trying to invert a singular matrix");
+        d = T(1) / d;
 
-    template <typename T, size_t n, size_t m, size_t w>
-    Matrix<T, n, w> operator*(const Matrix<T, n, m> &left, const Matrix<T, m, w> &right)
-    {
-        Matrix<T, n, w> result;
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < w; c++)
-                for (size_t k = 0; k < m; k++)
-                    result[r][c] += left[r][k] * right[k][c];
-        return std::move(result);
-    }
-    
-    template <typename T, size_t n, size_t m>
-    Matrix<T, n, m> operator*(const Matrix<T, n, m> &mat, T lambda)
-    {
-        Matrix<T, n, m> result;
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < m; c++)
-                result[r][c] = mat[r][c] * lambda;
-        return std::move(result);
-    }
-    
-    template <typename T, size_t n, size_t m>
-    Matrix<T, n, m> operator/(const Matrix<T, n, m> &mat, T lambda)
-    {
-        Matrix<T, n, m> result;
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < m; c++)
-                result[r][c] = mat[r][c] / lambda;
-        return std::move(result);
-    }
-    
-    template <typename T, size_t n, size_t m>
-    Matrix<T, n, m> operator*(T lambda, const Matrix<T, n, m> &mat)
-    {
         Matrix<T, n, m> result;
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < m; c++)
-                result[r][c] = mat[r][c] * lambda;
-        return std::move(result);
+        for (size_t r = 0; r < k; r++)
+        {
+            T t = T(0);
+            for (size_t c = 0; c < k; c++)
+            {
+                result.elements[r * n + c] = inv[r * k + c] * d;
+                t -= result.elements[r * n + c] * elements[c * n + k];
+            }
+            result.elements[r * n + k] = t;
+        }
+        result.elements[k * n + k] = T(1);
+        return result;
     }
 
     template <typename T, size_t n, size_t m>
-    Vector<T, n> operator*(const Matrix<T, n, m> &mat, const Vector<T, m> &vec)
+    std::ostream &operator<<(std::ostream &out, const Matrix<T, n, m> &mat)
     {
-        Vector<T, n> result;
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < m; c++)
-                result[r] += mat[r][c] * vec[c];
-        return std::move(result);
+        return out << mat.to_string();
     }
 
-    template <typename T, size_t n, size_t m>
-    Vector<T, m> operator*(const Vector<T, n> &vec, const Matrix<T, n, m> &mat)
+    template <typename T, size_t n, size_t m, size_t w>
+    constexpr Matrix<T, n, w> operator*(const Matrix<T, n, m> &left, const Matrix<T, m, w> &right)
     {
-        Vector<T, m> result;
-        for (size_t r = 0; r < n; r++)
-            for (size_t c = 0; c < m; c++)
-                result[c] += mat[r][c] * vec[r];
-        return std::move(result);
+        Matrix<T, n, w> result;
+        if constexpr (n == 4 && m == 4 && w == 4 && SimdSupport<T, 4>::value && std::is_same<accumulator_t<T>, T>::value)
+        {
+            if (!is_constant_evaluated())
+            {
+                simd_mat4_mul(left.elements, right.elements, result.elements);
+                return result;
+            }
+        }
+        if constexpr (n <= 4 && m <= 4 && w <= 4)
+            gemm_unrolled<T, n, m, w>(left.elements, right.elements, result.elements);
+        else if (is_constant_evaluated())
+            gemm_rkc(n, m, w, left.elements, m, right.elements, w, result.elements, w);
+        else
+            gemm(n, m, w, left.elements, m, right.elements, w, result.elements, w);
+        return result;
     }
-
+    
     template <typename T, size_t n, size_t m>
-    Matrix<T, n, m> operator+(const Matrix<T, n, m> &left, const Matrix<T, n, m> &right)
+    constexpr Vector<T, n> operator*(const Matrix<T, n, m> &mat, const Vector<T, m> &vec)
     {
-        Matrix<T, n, m> result;
+        using Acc = accumulator_t<T>;
+        Vector<T, n> result;
+        if constexpr (n == 4 && m == 4 && SimdSupport<T, 4>::value && std::is_same<Acc, T>::value)
+        {
+            if (!is_constant_evaluated())
+            {
+                simd_mat4_mul_vec(mat.elements, vec.elements, result.elements);
+                return result;
+            }
+        }
         for (size_t r = 0; r < n; r++)
+        {
+            Acc sum = Acc();
             for (size_t c = 0; c < m; c++)
-                result[r][c] = left[r][c] + right[r][c];
-        return std::move(result);
+                sum += Acc(mat[r][c]) * Acc(vec[c]);
+            result[r] = T(sum);
+        }
+        return result;
     }
 
     template <typename T, size_t n, size_t m>
-    Matrix<T, n, m> operator-(const Matrix<T, n, m> &left, const Matrix<T, n, m> &right)
+    constexpr Vector<T, m> operator*(const Vector<T, n> &vec, const Matrix<T, n, m> &mat)
     {
-        Matrix<T, n, m> result;
+        using Acc = accumulator_t<T>;
+        Acc sums[m] = {};
         for (size_t r = 0; r < n; r++)
             for (size_t c = 0; c < m; c++)
-                result[r][c] = left[r][c] - right[r][c];
-        return std::move(result);
+                sums[c] += Acc(mat[r][c]) * Acc(vec[r]);
+        Vector<T, m> result;
+        for (size_t c = 0; c < m; c++)
+            result[c] = T(sums[c]);
+        return result;
     }
-    
+
     template <typename T, size_t n, size_t m, size_t w>
     bool operator==(const Matrix<T, n, m> &left, const Matrix<T, m, w> &right)
     {
@@ -2,9 +2,26 @@
 #define MUTH_H
 
 #include "NumTool.h"
+#include "Half.h"
+#include "Arena.h"
+#include "Storage.h"
 #include "Vector.h"
 #include "Matrix.h"
 #include "Vec2.h"
 #include "Vec3.h"
+#include "VecBatch.h"
+#include "MatBatch.h"
+#include "Quat.h"
+#include "Transform.h"
+#include "DynVector.h"
+#include "DynMatrix.h"
+#include "View.h"
+#include "LU.h"
+#include "Cholesky.h"
+#include "QR.h"
+#include "Eigen.h"
+#include "Sparse.h"
+#include "Krylov.h"
+#include "Quantize.h"
 
 #endif
\ No newline at end of file
@@ -1,14 +1,64 @@
 #ifndef MUTH_NUM_TOOL_H
 #define MUTH_NUM_TOOL_H
 
+#include <cstdint>
 #include <limits>
 #include <cmath>
+#include <type_traits>
 
 namespace Muth
 {
 
+    // True while the enclosing constexpr call is being evaluated at compile
+    // time. Lets constexpr functions keep SIMD and pooled paths for runtime.
+    constexpr bool is_constant_evaluated() noexcept
+    {
+#if defined(__cpp_lib_is_constant_evaluated)
+        return std::is_constant_evaluated();
+#elif defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9)
+        return __builtin_is_constant_evaluated();
+#else
+        return false;
+#endif
+    }
+
+    // Type that sums of products of T are accumulated in (dot, length_square,
+    // matrix products). Narrow integers widen to 32 bits so products cannot
+    // overflow; define MUTH_ACCUMULATE_FLOAT_IN_DOUBLE to do the same for
+    // float. Float matrix products then take the packed gemm kernel at any
+    // size and round into the result once per KC panel; 4x4 products lose
+    // their SIMD kernels. Specialize to choose another accumulator for a type.
+    template <typename T>
+    struct Accumulator
+    {
+        using type = T;
+    };
+    template <>
+    struct Accumulator<int8_t> { using type = int32_t; };
+    template <>
+    struct Accumulator<uint8_t> { using type = uint32_t; };
+    template <>
+    struct Accumulator<int16_t> { using type = int32_t; };
+    template <>
+    struct Accumulator<uint16_t> { using type = uint32_t; };
+#ifdef MUTH_ACCUMULATE_FLOAT_IN_DOUBLE
+    template <>
+    struct Accumulator<float> { using type = double; };
+#endif
+
+    template <typename T>
+    using accumulator_t = typename Accumulator<T>::type;
+
+    // Integers compare exactly; other types need a specialization (see
+    // Half.h) and are treated as zero without one.
     template <typename T>
-    inline bool nonzero(T obj) { return false; }
+    inline bool nonzero(T obj)
+    {
+        if constexpr (std::is_integral<T>::value)
+            return obj != T(0);
+        else
+            return false;
+    }
     template <>
     inline bool nonzero(short obj) { return obj != 0; }
     template <>
@@ -29,6 +79,15 @@ namespace Muth
     template <>
     inline bool equal(double x, double y) { return std::abs(x - y) < std::numeric_limits<float>::epsilon(); }
 
+    // Scale-relative zero test for pivots, determinants and ranks: true when
+    // |x| is within count rounding errors of scale. Unlike nonzero() it keeps
+    // small but well-scaled values; for integers it is an exact zero test.
+    template <typename T>
+    inline bool negligible(T x, T scale, size_t count)
+    {
+        return std::abs(x) <= T(count) * std::numeric_limits<T>::epsilon() * scale;
+    }
+
 } // namespace Muth
 
 #endif
\ No newline at end of file
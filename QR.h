@@ -0,0 +1,375 @@
+#ifndef MUTH_QR_H
+#define MUTH_QR_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "ThreadPool.h"
+#include "Matrix.h"
+#include "DynMatrix.h"
+#include "View.h"
+
+// Panel width of the blocked Householder QR.
+#ifndef MUTH_QR_NB
+#define MUTH_QR_NB 32
+#endif
+
+namespace Muth
+{
+
+    constexpr size_t qr_nb = MUTH_QR_NB;
+
+    // Scratch elements qr_factor needs for m columns.
+    constexpr size_t qr_work_size(size_t m)
+    {
+        return m <= qr_nb ? m : qr_nb * qr_nb + qr_nb * m;
+    }
+
+    // Unblocked Householder QR of columns [k, kend) of a row-major n x m block,
+    // also updating columns up to kend only. Reflector j is H = I - tau v v^T
+    // with v[j] = 1 implied and v below the diagonal stored in place of the
+    // zeros it creates; R overwrites the upper triangle. w needs m elements.
+    template <typename T>
+    void qr_panel(T *a, size_t n, size_t m, size_t k, size_t kend, T *tau, T *w)
+    {
+        for (size_t j = k; j < kend && j < n; j++)
+        {
+            const T alpha = a[j * m + j];
+            T xnorm_sq = T(0);
+            for (size_t i = j + 1; i < n; i++)
+                xnorm_sq += a[i * m + j] * a[i * m + j];
+            if (xnorm_sq == T(0))
+            {
+                tau[j] = T(0);
+                continue;
+            }
+            const T norm = std::sqrt(alpha * alpha + xnorm_sq);
+            const T beta = alpha >= T(0) ? -norm : norm;
+            tau[j] = (beta - alpha) / beta;
+            const T scale = T(1) / (alpha - beta);
+            for (size_t i = j + 1; i < n; i++)
+                a[i * m + j] *= scale;
+            a[j * m + j] = beta;
+
+            // columns j+1 .. kend-1: w = v^T C, C -= tau v w
+            for (size_t c = j + 1; c < kend; c++)
+                w[c] = a[j * m + c];
+            for (size_t i = j + 1; i < n; i++)
+            {
+                const T v = a[i * m + j];
+                const T *row = a + i * m;
+                for (size_t c = j + 1; c < kend; c++)
+                    w[c] += v * row[c];
+            }
+            for (size_t c = j + 1; c < kend; c++)
+                a[j * m + c] -= tau[j] * w[c];
+            for (size_t i = j + 1; i < n; i++)
+            {
+                const T v = tau[j] * a[i * m + j];
+                T *row = a + i * m;
+                for (size_t c = j + 1; c < kend; c++)
+                    row[c] -= v * w[c];
+            }
+        }
+    }
+
+    // Element r of Householder vector k + l (implicit unit diagonal).
+    template <typename T>
+    inline T qr_v(const T *a, size_t m, size_t r, size_t col)
+    {
+        return r == col ? T(1) : (r < col ? T(0) : a[r * m + col]);
+    }
+
+    // Householder QR of a row-major n x m block (n >= m). Panels of
+    // MUTH_QR_NB columns are factored unblocked, their reflectors are
+    // accumulated into the compact WY form H = I - V T V^T, and the trailing
+    // columns are updated with C -= V (T^T (V^T C)), split by column ranges
+    // across the opt-in thread pool. work needs qr_work_size(m) elements.
+    template <typename T>
+    void qr_factor(T *a, size_t n, size_t m, T *tau, T *work)
+    {
+        if (m <= qr_nb)
+        {
+            qr_panel(a, n, m, 0, m, tau, work);
+            return;
+        }
+
+        T *t = work;
+        T *w = work + qr_nb * qr_nb;
+        for (size_t k = 0; k < m && k < n; k += qr_nb)
+        {
+            const size_t kend = std::min(std::min(k + qr_nb, m), n);
+            const size_t nb = kend - k;
+            qr_panel(a, n, m, k, kend, tau, w);
+            if (kend >= m)
+                break;
+
+            // T: upper triangular nb x nb, T[i][i] = tau_i,
+            // T[0..i)[i] = -tau_i T[0..i)[0..i) (V^T v_i)
+            for (size_t i = 0; i < nb; i++)
+            {
+                const size_t ci = k + i;
+                T *z = w;
+                for (size_t l = 0; l < i; l++)
+                {
+                    T sum = a[ci * m + k + l];
+                    for (size_t r = ci + 1; r < n; r++)
+                        sum += a[r * m + k + l] * a[r * m + ci];
+                    z[l] = sum;
+                }
+                for (size_t row = 0; row < i; row++)
+                {
+                    T sum = T(0);
+                    for (size_t l = row; l < i; l++)
+                        sum += t[row * qr_nb + l] * z[l];
+                    t[row * qr_nb + i] = -tau[ci] * sum;
+                }
+                t[i * qr_nb + i] = tau[ci];
+            }
+
+            parallel_for(kend, m, (n - k) * nb, parallel_config().eliminate_min, [&](size_t lo, size_t hi) {
+                const size_t width = hi - lo;
+                std::vector<T> wy(nb * width, T(0));
+                // wy = V^T C
+                for (size_t r = k; r < n; r++)
+                {
+                    const T *row = a + r * m + lo;
+                    for (size_t l = 0; l < nb && k + l <= r; l++)
+                    {
+                        const T v = qr_v(a, m, r, k + l);
+                        T *dst = wy.data() + l * width;
+                        for (size_t c = 0; c < width; c++)
+                            dst[c] += v * row[c];
+                    }
+                }
+                // wy = T^T wy, bottom-up so each row only reads rows above it
+                for (size_t l = nb; l-- > 0;)
+                {
+                    T *dst = wy.data() + l * width;
+                    for (size_t c = 0; c < width; c++)
+                        dst[c] *= t[l * qr_nb + l];
+                    for (size_t p = 0; p < l; p++)
+                    {
+                        const T coef = t[p * qr_nb + l];
+                        const T *src = wy.data() + p * width;
+                        for (size_t c = 0; c < width; c++)
+                            dst[c] += coef * src[c];
+                    }
+                }
+                // C -= V wy
+                for (size_t r = k; r < n; r++)
+                {
+                    T *row = a + r * m + lo;
+                    for (size_t l = 0; l < nb && k + l <= r; l++)
+                    {
+                        const T v = qr_v(a, m, r, k + l);
+                        const T *src = wy.data() + l * width;
+                        for (size_t c = 0; c < width; c++)
+                            row[c] -= v * src[c];
+                    }
+                }
+            });
+        }
+    }
+
+    // b <- Q^T b for the reflectors stored by qr_factor.
+    template <typename T>
+    void qr_apply_qt(const T *a, size_t n, size_t m, const T *tau, T *b)
+    {
+        for (size_t j = 0; j < m && j < n; j++)
+        {
+            if (tau[j] == T(0))
+                continue;
+            T sum = b[j];
+            for (size_t i = j + 1; i < n; i++)
+                sum += a[i * m + j] * b[i];
+            sum *= tau[j];
+            b[j] -= sum;
+            for (size_t i = j + 1; i < n; i++)
+                b[i] -= sum * a[i * m + j];
+        }
+    }
+
+    // b <- Q b, reflectors applied in reverse order.
+    template <typename T>
+    void qr_apply_q(const T *a, size_t n, size_t m, const T *tau, T *b)
+    {
+        for (size_t j = std::min(m, n); j-- > 0;)
+        {
+            if (tau[j] == T(0))
+                continue;
+            T sum = b[j];
+            for (size_t i = j + 1; i < n; i++)
+                sum += a[i * m + j] * b[i];
+            sum *= tau[j];
+            b[j] -= sum;
+            for (size_t i = j + 1; i < n; i++)
+                b[i] -= sum * a[i * m + j];
+        }
+    }
+
+    // Whether qr_factor output has full column rank: no diagonal element of R
+    // within max(n, m) eps of the largest one.
+    template <typename T>
+    bool qr_full_rank(const T *a, size_t n, size_t m)
+    {
+        T rmax = T(0);
+        for (size_t i = 0; i < m; i++)
+            rmax = std::max(rmax, T(std::abs(a[i * m + i])));
+        for (size_t i = 0; i < m; i++)
+            if (negligible(a[i * m + i], rmax, std::max(n, m)))
+                return false;
+        return true;
+    }
+
+    // Minimizes |A x - b| given qr_factor output: x = R^-1 (Q^T b)[0, m).
+    // b (n elements) is overwritten; x receives m elements.
+    template <typename T>
+    void qr_least_squares(const T *a, size_t n, size_t m, const T *tau, T *b, T *x)
+    {
+        if (!qr_full_rank(a, n, m))
+            throw MuthExceptionInvalidOperation("least squares system is rank deficient");
+        qr_apply_qt(a, n, m, tau, b);
+        for (size_t i = m; i-- > 0;)
+        {
+            const T *row = a + i * m;
+            T sum = b[i];
+            for (size_t c = i + 1; c < m; c++)
+                sum -= row[c] * x[c];
+            x[i] = sum / row[i];
+        }
+    }
+
+    // Householder QR of an n x m Matrix with n >= m.
+    template <typename T, size_t n, size_t m>
+    struct QR
+    {
+        static_assert(n >= m, "QR needs at least as many rows as columns");
+
+    private:
+        Matrix<T, n, m> qr;
+        std::array<T, m> tau;
+
+    public:
+        QR(const Matrix<T, n, m> &mat);
+
+        Matrix<T, m, m> R() const;
+        Matrix<T, n, m> Q() const;
+        bool full_rank() const;
+
+        Vector<T, n> apply_qt(const Vector<T, n> &b) const;
+        Vector<T, n> apply_q(const Vector<T, n> &b) const;
+        Vector<T, m> solve(const Vector<T, n> &b) const;
+    };
+
+    template <typename T, size_t n, size_t m>
+    QR<T, n, m>::QR(const Matrix<T, n, m> &mat) : qr(mat)
+    {
+        if constexpr (qr_work_size(m) <= 1024)
+        {
+            std::array<T, qr_work_size(m)> work;
+            qr_factor(qr.elements, n, m, tau.data(), work.data());
+        }
+        else
+        {
+            std::vector<T> work(qr_work_size(m));
+            qr_factor(qr.elements, n, m, tau.data(), work.data());
+        }
+    }
+
+    template <typename T, size_t n, size_t m>
+    Matrix<T, m, m> QR<T, n, m>::R() const
+    {
+        Matrix<T, m, m> r;
+        for (size_t i = 0; i < m; i++)
+            for (size_t c = i; c < m; c++)
+                r[i][c] = qr[i][c];
+        return r;
+    }
+
+    template <typename T, size_t n, size_t m>
+    Matrix<T, n, m> QR<T, n, m>::Q() const
+    {
+        Matrix<T, n, m> q;
+        std::array<T, n> column;
+        for (size_t c = 0; c < m; c++)
+        {
+            column.fill(T(0));
+            column[c] = T(1);
+            qr_apply_q(qr.elements, n, m, tau.data(), column.data());
+            for (size_t r = 0; r < n; r++)
+                q[r][c] = column[r];
+        }
+        return q;
+    }
+
+    template <typename T, size_t n, size_t m>
+    bool QR<T, n, m>::full_rank() const
+    {
+        return qr_full_rank(qr.elements, n, m);
+    }
+
+    template <typename T, size_t n, size_t m>
+    Vector<T, n> QR<T, n, m>::apply_qt(const Vector<T, n> &b) const
+    {
+        Vector<T, n> result(b);
+        qr_apply_qt(qr.elements, n, m, tau.data(), result.elements);
+        return result;
+    }
+
+    template <typename T, size_t n, size_t m>
+    Vector<T, n> QR<T, n, m>::apply_q(const Vector<T, n> &b) const
+    {
+        Vector<T, n> result(b);
+        qr_apply_q(qr.elements, n, m, tau.data(), result.elements);
+        return result;
+    }
+
+    template <typename T, size_t n, size_t m>
+    Vector<T, m> QR<T, n, m>::solve(const Vector<T, n> &b) const
+    {
+        Vector<T, n> rhs(b);
+        Vector<T, m> x;
+        qr_least_squares(qr.elements, n, m, tau.data(), rhs.elements, x.elements);
+        return x;
+    }
+
+    // x minimizing |a x - b|; throws if a does not have full column rank.
+    template <typename T, size_t n, size_t m>
+    Vector<T, m> least_squares(const Matrix<T, n, m> &a, const Vector<T, n> &b)
+    {
+        return QR<T, n, m>(a).solve(b);
+    }
+
+    // Views are copied into compact scratch storage before factorizing.
+    template <typename A, Layout L, typename B, typename = EnableIfSameElement<A, B>>
+    DynVector<std::remove_const_t<A>> least_squares(const MatrixView<A, L> &a, const VectorView<B> &b)
+    {
+        using T = std::remove_const_t<A>;
+        const size_t n = a.rows(), m = a.cols();
+        if (n < m)
+            throw MuthExceptionInvalidOperation("least squares needs at least as many rows as columns");
+        if (b.size() != n)
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        DynMatrix<T> qr = a.clone();
+        DynVector<T> rhs = b.clone();
+        DynVector<T> x(m);
+        std::vector<T> tau(m), work(qr_work_size(m));
+        qr_factor(qr.elements, n, m, tau.data(), work.data());
+        qr_least_squares(qr.elements, n, m, tau.data(), rhs.elements, x.elements);
+        return x;
+    }
+
+    template <typename T>
+    DynVector<T> least_squares(const DynMatrix<T> &a, const DynVector<T> &b)
+    {
+        return least_squares(view(a), view(b));
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
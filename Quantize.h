@@ -0,0 +1,185 @@
+#ifndef MUTH_QUANTIZE_H
+#define MUTH_QUANTIZE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "Gemm.h"
+#include "DynVector.h"
+#include "DynMatrix.h"
+
+namespace Muth
+{
+
+    // Integer type quantized products are summed in. int32 holds about 130k
+    // full-scale int8 products but fewer than three int16 ones, so int16
+    // sums go to int64, which holds about 8.6e9.
+    template <typename Q>
+    using quantized_accumulator_t = std::conditional_t<(sizeof(Q) == 1), int32_t, int64_t>;
+
+    // Symmetric linear quantization: x ~= scale * q with q an integer of
+    // type Q in [-max, max]. Returns the scale, chosen so the largest |x|
+    // maps to max; an all-zero input gets scale 1.
+    template <typename Q, typename T>
+    T quantize(const T *in, Q *out, size_t count)
+    {
+        static_assert(std::numeric_limits<Q>::is_integer && std::numeric_limits<Q>::is_signed && sizeof(Q) <= 2,
+                      "quantized type must be a signed integer of at most 16 bits");
+        const T q_max = T(std::numeric_limits<Q>::max());
+        T peak = T(0);
+        for (size_t i = 0; i < count; i++)
+            peak = std::max(peak, T(std::abs(in[i])));
+        const T scale = peak > T(0) ? peak / q_max : T(1);
+        const T inv_scale = T(1) / scale;
+        for (size_t i = 0; i < count; i++)
+            out[i] = Q(std::clamp(T(std::round(in[i] * inv_scale)), -q_max, q_max));
+        return scale;
+    }
+
+    template <typename Q, typename T>
+    void dequantize(const Q *in, T scale, T *out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = T(in[i]) * scale;
+    }
+
+    // Integer dot product summed in quantized_accumulator_t<Q>, exact for
+    // full-scale inputs up to the counts above.
+    template <typename Q>
+    quantized_accumulator_t<Q> dot_quantized(const Q *a, const Q *b, size_t count)
+    {
+        using Acc = quantized_accumulator_t<Q>;
+        Acc sum = Acc();
+        for (size_t i = 0; i < count; i++)
+            sum += Acc(a[i]) * Acc(b[i]);
+        return sum;
+    }
+
+    // c(n x w) = a_scale * b_scale * (a(n x m) * b(m x w)) for quantized a
+    // and b: the product runs entirely in integers through gemm_accumulate
+    // and is rescaled once per output.
+    template <typename Q, typename T>
+    void gemm_quantized(size_t n, size_t m, size_t w, const Q *a, size_t lda, T a_scale, const Q *b, size_t ldb, T b_scale, T *c, size_t ldc)
+    {
+        std::vector<quantized_accumulator_t<Q>> sums(n * w);
+        gemm_accumulate(n, m, w, a, lda, b, ldb, sums.data(), w);
+        const T scale = a_scale * b_scale;
+        for (size_t r = 0; r < n; r++)
+            for (size_t col = 0; col < w; col++)
+                c[r * ldc + col] = T(sums[r * w + col]) * scale;
+    }
+
+    // Row-major matrix stored as Q integers with one shared scale. An int8
+    // copy of a float matrix moves a quarter of the bytes through memory;
+    // products accumulate in quantized_accumulator_t<Q> and come back as T.
+    template <typename Q, typename T = float>
+    struct QuantizedMatrix
+    {
+    private:
+        size_t n;
+        size_t m;
+        T scale_;
+        std::vector<Q> vals;
+
+    public:
+        QuantizedMatrix() : n(0), m(0), scale_(T(1)) {}
+        QuantizedMatrix(size_t rows, size_t cols, const T *dense);
+        explicit QuantizedMatrix(const DynMatrix<T> &mat) : QuantizedMatrix(mat.rows(), mat.cols(), mat.elements) {}
+        template <size_t rows, size_t cols>
+        explicit QuantizedMatrix(const Matrix<T, rows, cols> &mat) : QuantizedMatrix(rows, cols, mat.elements) {}
+
+        size_t rows() const { return n; }
+        size_t cols() const { return m; }
+        T scale() const { return scale_; }
+        const Q *values() const { return vals.data(); }
+
+        T get(size_t r, size_t c) const;
+        DynMatrix<T> to_dense() const;
+        std::string to_string(const std::string &separator = " ", const std::string &end_row = "") const;
+    };
+
+    template <typename Q, typename T>
+    QuantizedMatrix<Q, T>::QuantizedMatrix(size_t rows, size_t cols, const T *dense) : n(rows), m(cols), vals(rows * cols)
+    {
+        scale_ = quantize(dense, vals.data(), vals.size());
+    }
+
+    template <typename Q, typename T>
+    inline T QuantizedMatrix<Q, T>::get(size_t r, size_t c) const
+    {
+        if (r >= n || c >= m)
+            throw MuthOutOfRangeException("quantized matrix index out of range");
+        return T(vals[r * m + c]) * scale_;
+    }
+
+    template <typename Q, typename T>
+    DynMatrix<T> QuantizedMatrix<Q, T>::to_dense() const
+    {
+        DynMatrix<T> result(n, m);
+        dequantize(vals.data(), scale_, result.elements, vals.size());
+        return result;
+    }
+
+    template <typename Q, typename T>
+    std::string QuantizedMatrix<Q, T>::to_string(const std::string &separator, const std::string &end_row) const
+    {
+        std::stringstream ss;
+        for (size_t r = 0; r < n; r++)
+        {
+            for (size_t c = 0; c < m; c++)
+            {
+                ss << quantized_accumulator_t<Q>(vals[r * m + c]);
+                if (c + 1 < m)
+                    ss << separator;
+            }
+            ss << end_row;
+            if (r + 1 < n)
+                ss << '\n';
+        }
+        ss << " * " << scale_;
+        return ss.str();
+    }
+
+    template <typename Q, typename T>
+    DynMatrix<T> operator*(const QuantizedMatrix<Q, T> &left, const QuantizedMatrix<Q, T> &right)
+    {
+        if (left.cols() != right.rows())
+            throw MuthExceptionInvalidOperation("matrix shapes do not match");
+        DynMatrix<T> result(left.rows(), right.cols());
+        gemm_quantized(left.rows(), left.cols(), right.cols(), left.values(), left.cols(), left.scale(),
+                       right.values(), right.cols(), right.scale(), result.elements, right.cols());
+        return result;
+    }
+
+    // Quantizes vec on the fly with its own scale, then runs one integer
+    // dot product per row.
+    template <typename Q, typename T>
+    DynVector<T> operator*(const QuantizedMatrix<Q, T> &mat, const DynVector<T> &vec)
+    {
+        if (mat.cols() != vec.size())
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        std::vector<Q> q(vec.size());
+        const T scale = mat.scale() * quantize(vec.elements, q.data(), q.size());
+        DynVector<T> result(mat.rows());
+        for (size_t r = 0; r < mat.rows(); r++)
+            result[r] = T(dot_quantized(mat.values() + r * mat.cols(), q.data(), q.size())) * scale;
+        return result;
+    }
+
+    template <typename Q, typename T>
+    inline std::ostream &operator<<(std::ostream &out, const QuantizedMatrix<Q, T> &mat)
+    {
+        return out << mat.to_string();
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
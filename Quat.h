@@ -0,0 +1,227 @@
+#ifndef MUTH_QUAT_H
+#define MUTH_QUAT_H
+
+#include <cmath>
+#include <string>
+#include <sstream>
+
+#include "Vec3.h"
+#include "Matrix.h"
+#include "VecBatch.h"
+
+namespace Muth
+{
+    // Rotation quaternion w + xi + yj + zk. Composition costs 16 multiplies
+    // against 27 for a Mat3 product, and renormalizing with normalized() is
+    // enough to remove accumulated drift. Rotations assume unit length.
+    template<typename T>
+    struct Quat
+    {
+    public:
+        T w;
+        T x;
+        T y;
+        T z;
+
+    public:
+        constexpr Quat() : w(1), x(0), y(0), z(0) {}
+        constexpr Quat(const T &w, const T &x, const T &y, const T &z) : w(w), x(x), y(y), z(z) {}
+        constexpr Quat(const T &w, const Vec3<T> &v) : w(w), x(v.x), y(v.y), z(v.z) {}
+
+        static Quat<T> from_axis_angle(const Vec3<T> &axis, T angle);
+        static Quat<T> from_matrix(const Mat3<T> &mat);
+
+    public:
+        constexpr Vec3<T> vec() const { return { x, y, z }; }
+
+        std::string to_string(const std::string &separator = " ") const
+        {
+            std::stringstream ss;
+            ss << w << separator << x << separator << y << separator << z;
+            return ss.str();
+        }
+
+    public:
+        constexpr T length_square() const { return w * w + x * x + y * y + z * z; }
+        T length() const { return std::sqrt(this->length_square()); }
+        Quat<T> normalized() const { return (*this) * (T(1) / this->length()); }
+        constexpr T dot(const Quat<T> &other) const { return w * other.w + x * other.x + y * other.y + z * other.z; }
+        constexpr Quat<T> conjugate() const { return { w, -x, -y, -z }; }
+        constexpr Quat<T> inverse() const { return this->conjugate() * (T(1) / this->length_square()); }
+
+        constexpr Vec3<T> rotate(const Vec3<T> &v) const;
+        constexpr Mat3<T> to_matrix() const;
+
+    public:
+        constexpr Quat<T> &operator*= (const Quat<T> &other) { *this = (*this) * other; return *this; }
+    };
+
+    template <typename T>
+    inline Quat<T> Quat<T>::from_axis_angle(const Vec3<T> &axis, T angle)
+    {
+        const Vec3<T> unit = axis.normalized();
+        const T half = angle / T(2);
+        return { std::cos(half), unit * std::sin(half) };
+    }
+
+    // Shepperd's method: divides by the largest of the four candidate
+    // components, so it stays accurate near 180 degree rotations.
+    template <typename T>
+    inline Quat<T> Quat<T>::from_matrix(const Mat3<T> &mat)
+    {
+        const T m00 = mat[0][0], m01 = mat[0][1], m02 = mat[0][2];
+        const T m10 = mat[1][0], m11 = mat[1][1], m12 = mat[1][2];
+        const T m20 = mat[2][0], m21 = mat[2][1], m22 = mat[2][2];
+        const T trace = m00 + m11 + m22;
+        if (trace > T(0))
+        {
+            const T s = std::sqrt(trace + T(1)) * T(2);
+            return { s / T(4), (m21 - m12) / s, (m02 - m20) / s, (m10 - m01) / s };
+        }
+        if (m00 > m11 && m00 > m22)
+        {
+            const T s = std::sqrt(T(1) + m00 - m11 - m22) * T(2);
+            return { (m21 - m12) / s, s / T(4), (m01 + m10) / s, (m02 + m20) / s };
+        }
+        if (m11 > m22)
+        {
+            const T s = std::sqrt(T(1) + m11 - m00 - m22) * T(2);
+            return { (m02 - m20) / s, (m01 + m10) / s, s / T(4), (m12 + m21) / s };
+        }
+        const T s = std::sqrt(T(1) + m22 - m00 - m11) * T(2);
+        return { (m10 - m01) / s, (m02 + m20) / s, (m12 + m21) / s, s / T(4) };
+    }
+
+    // v + w t + u x t with t = 2 (u x v): 15 multiplies, no matrix.
+    template <typename T>
+    constexpr Vec3<T> Quat<T>::rotate(const Vec3<T> &v) const
+    {
+        const T tx = T(2) * (y * v.z - z * v.y);
+        const T ty = T(2) * (z * v.x - x * v.z);
+        const T tz = T(2) * (x * v.y - y * v.x);
+        return {
+            v.x + w * tx + (y * tz - z * ty),
+            v.y + w * ty + (z * tx - x * tz),
+            v.z + w * tz + (x * ty - y * tx),
+        };
+    }
+
+    template <typename T>
+    constexpr Mat3<T> Quat<T>::to_matrix() const
+    {
+        const T xx = x * x, yy = y * y, zz = z * z;
+        const T xy = x * y, xz = x * z, yz = y * z;
+        const T wx = w * x, wy = w * y, wz = w * z;
+        return {
+            T(1) - T(2) * (yy + zz), T(2) * (xy - wz), T(2) * (xz + wy),
+            T(2) * (xy + wz), T(1) - T(2) * (xx + zz), T(2) * (yz - wx),
+            T(2) * (xz - wy), T(2) * (yz + wx), T(1) - T(2) * (xx + yy),
+        };
+    }
+
+    // Hamilton product: (a * b) rotates by b first, then by a.
+    template <typename T>
+    constexpr Quat<T> operator*(const Quat<T> &a, const Quat<T> &b)
+    {
+        return {
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        };
+    }
+
+    template <typename T>
+    constexpr Vec3<T> operator*(const Quat<T> &q, const Vec3<T> &v)
+    {
+        return q.rotate(v);
+    }
+
+    template <typename T>
+    constexpr Quat<T> operator+(const Quat<T> &left, const Quat<T> &right)
+    {
+        return { left.w + right.w, left.x + right.x, left.y + right.y, left.z + right.z };
+    }
+
+    template <typename T>
+    constexpr Quat<T> operator-(const Quat<T> &left, const Quat<T> &right)
+    {
+        return { left.w - right.w, left.x - right.x, left.y - right.y, left.z - right.z };
+    }
+
+    template <typename T>
+    constexpr Quat<T> operator*(const Quat<T> &q, T lambda)
+    {
+        return { q.w * lambda, q.x * lambda, q.y * lambda, q.z * lambda };
+    }
+
+    template <typename T>
+    constexpr Quat<T> operator*(T lambda, const Quat<T> &q)
+    {
+        return q * lambda;
+    }
+
+    template <typename T>
+    constexpr Quat<T> operator-(const Quat<T> &q)
+    {
+        return { -q.w, -q.x, -q.y, -q.z };
+    }
+
+    template <typename T>
+    inline std::ostream &operator<<(std::ostream &out, const Quat<T> &q)
+    {
+        return out << q.to_string();
+    }
+
+    // Normalized linear interpolation along the shorter arc. Not constant
+    // speed, but cheap and close to slerp for small angles.
+    template <typename T>
+    inline Quat<T> nlerp(const Quat<T> &a, const Quat<T> &b, T t)
+    {
+        const Quat<T> target = a.dot(b) < T(0) ? -b : b;
+        return (a * (T(1) - t) + target * t).normalized();
+    }
+
+    // Constant angular speed interpolation along the shorter arc. Falls back
+    // to nlerp when the endpoints are nearly parallel.
+    template <typename T>
+    inline Quat<T> slerp(const Quat<T> &a, const Quat<T> &b, T t)
+    {
+        T d = a.dot(b);
+        const Quat<T> target = d < T(0) ? -b : b;
+        d = std::abs(d);
+        if (d > T(0.9995))
+            return nlerp(a, target, t);
+        const T theta = std::acos(d);
+        const T inv_sin = T(1) / std::sin(theta);
+        return a * (std::sin((T(1) - t) * theta) * inv_sin) + target * (std::sin(t * theta) * inv_sin);
+    }
+
+    // Rotates count vectors. Converts q to a matrix once: 9 multiplies per
+    // vector instead of 15, and no dependency chain across the three lanes.
+    template <typename T>
+    void rotate(const Quat<T> &q, const Vec3<T> *vecs, Vec3<T> *out, size_t count)
+    {
+        const Mat3<T> mat = q.to_matrix();
+        const T m00 = mat[0][0], m01 = mat[0][1], m02 = mat[0][2];
+        const T m10 = mat[1][0], m11 = mat[1][1], m12 = mat[1][2];
+        const T m20 = mat[2][0], m21 = mat[2][1], m22 = mat[2][2];
+        for (size_t i = 0; i < count; i++)
+        {
+            const T px = vecs[i].x, py = vecs[i].y, pz = vecs[i].z;
+            out[i] = {
+                m00 * px + m01 * py + m02 * pz,
+                m10 * px + m11 * py + m12 * pz,
+                m20 * px + m21 * py + m22 * pz,
+            };
+        }
+    }
+
+    template <typename T>
+    void rotate(const Quat<T> &q, const Vec3Batch<T> &vecs, Vec3Batch<T> &out)
+    {
+        transform(q.to_matrix(), vecs, out);
+    }
+} // namespace Muth
+
+#endif
\ No newline at end of file
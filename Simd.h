@@ -0,0 +1,290 @@
+#ifndef MUTH_SIMD_H
+#define MUTH_SIMD_H
+
+#include <cstddef>
+#include <cmath>
+
+// Define MUTH_NO_SIMD to force the portable kernels.
+#if !defined(MUTH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define MUTH_SIMD_SSE 1
+#include <immintrin.h>
+#endif
+#if !defined(MUTH_NO_SIMD) && defined(__AVX__)
+#define MUTH_SIMD_AVX 1
+#endif
+#if !defined(MUTH_NO_SIMD) && defined(__AVX2__)
+#define MUTH_SIMD_AVX2 1
+#endif
+#if !defined(MUTH_NO_SIMD) && defined(__F16C__)
+#define MUTH_SIMD_F16C 1
+#endif
+
+namespace Muth
+{
+
+    // Whether the size-element kernels below (3: Vec3, 4: Mat4 and 4-vectors)
+    // have a vector-register overload for T on this target.
+    template <typename T, size_t size>
+    struct SimdSupport
+    {
+        static constexpr bool value = false;
+    };
+
+#ifdef MUTH_SIMD_SSE
+    template <>
+    struct SimdSupport<float, 3>
+    {
+        static constexpr bool value = true;
+    };
+    template <>
+    struct SimdSupport<float, 4>
+    {
+        static constexpr bool value = true;
+    };
+#endif
+#ifdef MUTH_SIMD_AVX
+    template <>
+    struct SimdSupport<double, 4>
+    {
+        static constexpr bool value = true;
+    };
+#endif
+#ifdef MUTH_SIMD_AVX2
+    template <>
+    struct SimdSupport<double, 3>
+    {
+        static constexpr bool value = true;
+    };
+#endif
+
+    // Portable kernels. All matrices are row-major 4x4; 3-vectors read three
+    // lanes here, while the vector-register overloads below read a fourth
+    // padding lane and so need the padded Vec3 layout.
+
+    template <typename T>
+    inline void simd_mat4_mul(const T *a, const T *b, T *out)
+    {
+        for (size_t r = 0; r < 4; r++)
+            for (size_t c = 0; c < 4; c++)
+                out[r * 4 + c] = a[r * 4] * b[c] + a[r * 4 + 1] * b[4 + c] + a[r * 4 + 2] * b[8 + c] + a[r * 4 + 3] * b[12 + c];
+    }
+
+    template <typename T>
+    inline void simd_mat4_mul_vec(const T *a, const T *v, T *out)
+    {
+        for (size_t r = 0; r < 4; r++)
+            out[r] = a[r * 4] * v[0] + a[r * 4 + 1] * v[1] + a[r * 4 + 2] * v[2] + a[r * 4 + 3] * v[3];
+    }
+
+    template <typename T>
+    inline T simd_dot3(const T *a, const T *b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    template <typename T>
+    inline void simd_cross3(const T *a, const T *b, T *out)
+    {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    template <typename T>
+    inline void simd_normalize3(const T *a, T *out)
+    {
+        const T len = std::sqrt(simd_dot3(a, a));
+        out[0] = a[0] / len;
+        out[1] = a[1] / len;
+        out[2] = a[2] / len;
+    }
+
+    // b = a^T for a 4x4 tile of a larger row-major matrix; a and b are rows
+    // apart by lda and ldb and must not overlap.
+    template <typename T>
+    inline void simd_transpose4(const T *a, size_t lda, T *b, size_t ldb)
+    {
+        for (size_t r = 0; r < 4; r++)
+            for (size_t c = 0; c < 4; c++)
+                b[c * ldb + r] = a[r * lda + c];
+    }
+
+#ifdef MUTH_SIMD_SSE
+    inline __m128 simd_madd(__m128 a, __m128 b, __m128 c)
+    {
+#ifdef __FMA__
+        return _mm_fmadd_ps(a, b, c);
+#else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+    }
+
+    inline void simd_mat4_mul(const float *a, const float *b, float *out)
+    {
+        const __m128 b0 = _mm_loadu_ps(b);
+        const __m128 b1 = _mm_loadu_ps(b + 4);
+        const __m128 b2 = _mm_loadu_ps(b + 8);
+        const __m128 b3 = _mm_loadu_ps(b + 12);
+        for (size_t r = 0; r < 4; r++)
+        {
+            const float *row = a + r * 4;
+            __m128 acc = _mm_mul_ps(_mm_set1_ps(row[0]), b0);
+            acc = simd_madd(_mm_set1_ps(row[1]), b1, acc);
+            acc = simd_madd(_mm_set1_ps(row[2]), b2, acc);
+            acc = simd_madd(_mm_set1_ps(row[3]), b3, acc);
+            _mm_storeu_ps(out + r * 4, acc);
+        }
+    }
+
+    inline void simd_mat4_mul_vec(const float *a, const float *v, float *out)
+    {
+        const __m128 x = _mm_loadu_ps(v);
+        __m128 r0 = _mm_mul_ps(_mm_loadu_ps(a), x);
+        __m128 r1 = _mm_mul_ps(_mm_loadu_ps(a + 4), x);
+        __m128 r2 = _mm_mul_ps(_mm_loadu_ps(a + 8), x);
+        __m128 r3 = _mm_mul_ps(_mm_loadu_ps(a + 12), x);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(out, _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3)));
+    }
+
+    inline __m128 simd_dot3_splat(__m128 a, __m128 b)
+    {
+        const __m128 p = _mm_mul_ps(a, b);
+        const __m128 sum = _mm_add_ss(_mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1))),
+                                      _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)));
+        return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+    }
+
+    inline float simd_dot3(const float *a, const float *b)
+    {
+        return _mm_cvtss_f32(simd_dot3_splat(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+    }
+
+    inline void simd_cross3(const float *a, const float *b, float *out)
+    {
+        const __m128 va = _mm_loadu_ps(a);
+        const __m128 vb = _mm_loadu_ps(b);
+        const __m128 a_yzx = _mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m128 b_yzx = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m128 c = _mm_sub_ps(_mm_mul_ps(va, b_yzx), _mm_mul_ps(a_yzx, vb));
+        _mm_storeu_ps(out, _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+    }
+
+    inline void simd_normalize3(const float *a, float *out)
+    {
+        const __m128 va = _mm_loadu_ps(a);
+        const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        // The padding lane is cleared, so a zero vector's 0 / 0 cannot leave
+        // a NaN in w for later four-lane operations.
+        _mm_storeu_ps(out, _mm_and_ps(_mm_div_ps(va, _mm_sqrt_ps(simd_dot3_splat(va, va))), xyz));
+    }
+
+    inline void simd_transpose4(const float *a, size_t lda, float *b, size_t ldb)
+    {
+        __m128 r0 = _mm_loadu_ps(a);
+        __m128 r1 = _mm_loadu_ps(a + lda);
+        __m128 r2 = _mm_loadu_ps(a + 2 * lda);
+        __m128 r3 = _mm_loadu_ps(a + 3 * lda);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(b, r0);
+        _mm_storeu_ps(b + ldb, r1);
+        _mm_storeu_ps(b + 2 * ldb, r2);
+        _mm_storeu_ps(b + 3 * ldb, r3);
+    }
+#endif
+
+#ifdef MUTH_SIMD_AVX
+    inline __m256d simd_madd(__m256d a, __m256d b, __m256d c)
+    {
+#ifdef __FMA__
+        return _mm256_fmadd_pd(a, b, c);
+#else
+        return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+    }
+
+    inline void simd_mat4_mul(const double *a, const double *b, double *out)
+    {
+        const __m256d b0 = _mm256_loadu_pd(b);
+        const __m256d b1 = _mm256_loadu_pd(b + 4);
+        const __m256d b2 = _mm256_loadu_pd(b + 8);
+        const __m256d b3 = _mm256_loadu_pd(b + 12);
+        for (size_t r = 0; r < 4; r++)
+        {
+            const double *row = a + r * 4;
+            __m256d acc = _mm256_mul_pd(_mm256_set1_pd(row[0]), b0);
+            acc = simd_madd(_mm256_set1_pd(row[1]), b1, acc);
+            acc = simd_madd(_mm256_set1_pd(row[2]), b2, acc);
+            acc = simd_madd(_mm256_set1_pd(row[3]), b3, acc);
+            _mm256_storeu_pd(out + r * 4, acc);
+        }
+    }
+
+    inline void simd_mat4_mul_vec(const double *a, const double *v, double *out)
+    {
+        const __m256d x = _mm256_loadu_pd(v);
+        const __m256d r0 = _mm256_mul_pd(_mm256_loadu_pd(a), x);
+        const __m256d r1 = _mm256_mul_pd(_mm256_loadu_pd(a + 4), x);
+        const __m256d r2 = _mm256_mul_pd(_mm256_loadu_pd(a + 8), x);
+        const __m256d r3 = _mm256_mul_pd(_mm256_loadu_pd(a + 12), x);
+        const __m256d s01 = _mm256_hadd_pd(r0, r1);
+        const __m256d s23 = _mm256_hadd_pd(r2, r3);
+        _mm256_storeu_pd(out, _mm256_add_pd(_mm256_permute2f128_pd(s01, s23, 0x20),
+                                             _mm256_permute2f128_pd(s01, s23, 0x31)));
+    }
+
+    // Pairs of rows are interleaved within 128-bit lanes, then the lanes of
+    // rows 0/1 and 2/3 are recombined.
+    inline void simd_transpose4(const double *a, size_t lda, double *b, size_t ldb)
+    {
+        const __m256d r0 = _mm256_loadu_pd(a);
+        const __m256d r1 = _mm256_loadu_pd(a + lda);
+        const __m256d r2 = _mm256_loadu_pd(a + 2 * lda);
+        const __m256d r3 = _mm256_loadu_pd(a + 3 * lda);
+        const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+        const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+        const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+        _mm256_storeu_pd(b, _mm256_permute2f128_pd(t0, t2, 0x20));
+        _mm256_storeu_pd(b + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+        _mm256_storeu_pd(b + 2 * ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+        _mm256_storeu_pd(b + 3 * ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+#endif
+
+#ifdef MUTH_SIMD_AVX2
+    inline __m256d simd_dot3_splat(__m256d a, __m256d b)
+    {
+        const __m256d p = _mm256_mul_pd(a, b);
+        const __m128d lo = _mm256_castpd256_pd128(p);
+        const __m128d hi = _mm256_extractf128_pd(p, 1);
+        const __m128d sum = _mm_add_sd(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)), hi);
+        return _mm256_broadcastsd_pd(sum);
+    }
+
+    inline double simd_dot3(const double *a, const double *b)
+    {
+        return _mm256_cvtsd_f64(simd_dot3_splat(_mm256_loadu_pd(a), _mm256_loadu_pd(b)));
+    }
+
+    inline void simd_cross3(const double *a, const double *b, double *out)
+    {
+        const __m256d va = _mm256_loadu_pd(a);
+        const __m256d vb = _mm256_loadu_pd(b);
+        const __m256d a_yzx = _mm256_permute4x64_pd(va, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m256d b_yzx = _mm256_permute4x64_pd(vb, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m256d c = _mm256_sub_pd(_mm256_mul_pd(va, b_yzx), _mm256_mul_pd(a_yzx, vb));
+        _mm256_storeu_pd(out, _mm256_permute4x64_pd(c, _MM_SHUFFLE(3, 0, 2, 1)));
+    }
+
+    inline void simd_normalize3(const double *a, double *out)
+    {
+        const __m256d va = _mm256_loadu_pd(a);
+        const __m256d unit = _mm256_div_pd(va, _mm256_sqrt_pd(simd_dot3_splat(va, va)));
+        _mm256_storeu_pd(out, _mm256_blend_pd(unit, _mm256_setzero_pd(), 0x8));
+    }
+#endif
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
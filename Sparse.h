@@ -0,0 +1,468 @@
+#ifndef MUTH_SPARSE_H
+#define MUTH_SPARSE_H
+
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "ThreadPool.h"
+#include "Matrix.h"
+#include "DynMatrix.h"
+
+namespace Muth
+{
+
+    // One (row, col, value) entry of a matrix under construction.
+    template <typename T>
+    struct Triplet
+    {
+        size_t row;
+        size_t col;
+        T value;
+    };
+
+    // Compresses triplets along one axis: ptr[i] .. ptr[i + 1] indexes the
+    // entries of major line i, sorted by minor index, duplicates summed.
+    // by_row picks rows as the major axis (CSR), otherwise columns (CSC).
+    template <typename T>
+    void sparse_compress(size_t rows, size_t cols, const std::vector<Triplet<T>> &triplets, bool by_row,
+                         std::vector<size_t> &ptr, std::vector<size_t> &idx, std::vector<T> &values)
+    {
+        const size_t major = by_row ? rows : cols;
+        std::vector<size_t> start(major + 1, 0);
+        for (const Triplet<T> &t : triplets)
+        {
+            if (t.row >= rows || t.col >= cols)
+                throw MuthOutOfRangeException("sparse entry index out of range");
+            start[(by_row ? t.row : t.col) + 1]++;
+        }
+        for (size_t i = 0; i < major; i++)
+            start[i + 1] += start[i];
+
+        std::vector<std::pair<size_t, T>> entries(triplets.size());
+        std::vector<size_t> next(start.begin(), start.end() - 1);
+        for (const Triplet<T> &t : triplets)
+            entries[next[by_row ? t.row : t.col]++] = { by_row ? t.col : t.row, t.value };
+
+        ptr.assign(major + 1, 0);
+        idx.clear();
+        values.clear();
+        idx.reserve(entries.size());
+        values.reserve(entries.size());
+        for (size_t i = 0; i < major; i++)
+        {
+            auto first = entries.begin() + start[i], last = entries.begin() + start[i + 1];
+            std::sort(first, last, [](const std::pair<size_t, T> &a, const std::pair<size_t, T> &b) { return a.first < b.first; });
+            for (auto it = first; it != last; ++it)
+            {
+                if (idx.size() > ptr[i] && idx.back() == it->first)
+                    values.back() += it->second;
+                else
+                {
+                    idx.push_back(it->first);
+                    values.push_back(it->second);
+                }
+            }
+            ptr[i + 1] = idx.size();
+        }
+    }
+
+    // Re-compresses along the other axis (CSR <-> CSC) in O(nnz + minor);
+    // entries come out sorted because major lines are visited in order.
+    template <typename T>
+    void sparse_transpose(size_t major, size_t minor,
+                          const std::vector<size_t> &ptr, const std::vector<size_t> &idx, const std::vector<T> &values,
+                          std::vector<size_t> &out_ptr, std::vector<size_t> &out_idx, std::vector<T> &out_values)
+    {
+        out_ptr.assign(minor + 1, 0);
+        out_idx.resize(idx.size());
+        out_values.resize(values.size());
+        for (size_t k = 0; k < idx.size(); k++)
+            out_ptr[idx[k] + 1]++;
+        for (size_t i = 0; i < minor; i++)
+            out_ptr[i + 1] += out_ptr[i];
+        std::vector<size_t> next(out_ptr.begin(), out_ptr.end() - 1);
+        for (size_t i = 0; i < major; i++)
+        {
+            for (size_t k = ptr[i]; k < ptr[i + 1]; k++)
+            {
+                const size_t dst = next[idx[k]]++;
+                out_idx[dst] = i;
+                out_values[dst] = values[k];
+            }
+        }
+    }
+
+    template <typename T>
+    struct SparseCSC;
+
+    // Compressed sparse row matrix: the column indices and values of row r are
+    // stored at [row_offsets()[r], row_offsets()[r + 1]), columns ascending.
+    // Products cost O(nnz) and are split by rows across the opt-in pool.
+    template <typename T>
+    struct SparseCSR
+    {
+    private:
+        size_t n;
+        size_t m;
+        std::vector<size_t> ptr;
+        std::vector<size_t> idx;
+        std::vector<T> vals;
+
+    public:
+        SparseCSR() : n(0), m(0), ptr(1, 0) {}
+        SparseCSR(size_t rows, size_t cols) : n(rows), m(cols), ptr(rows + 1, 0) {}
+        SparseCSR(size_t rows, size_t cols, const std::vector<Triplet<T>> &triplets);
+        SparseCSR(size_t rows, size_t cols, std::vector<size_t> row_offsets, std::vector<size_t> columns, std::vector<T> values);
+        template <size_t rows, size_t cols>
+        explicit SparseCSR(const Matrix<T, rows, cols> &mat) : SparseCSR(rows, cols, mat.elements) {}
+        explicit SparseCSR(const DynMatrix<T> &mat) : SparseCSR(mat.rows(), mat.cols(), mat.elements) {}
+        SparseCSR(size_t rows, size_t cols, const T *dense);
+
+        size_t rows() const { return n; }
+        size_t cols() const { return m; }
+        size_t nonzeros() const { return idx.size(); }
+        const std::vector<size_t> &row_offsets() const { return ptr; }
+        const std::vector<size_t> &columns() const { return idx; }
+        const std::vector<T> &values() const { return vals; }
+
+        T get(size_t row, size_t col) const;
+
+        DynMatrix<T> to_dense() const;
+        template <size_t rows, size_t cols>
+        Matrix<T, rows, cols> to_matrix() const;
+        SparseCSC<T> to_csc() const;
+        SparseCSR<T> transpose() const;
+
+        std::string to_string(const std::string &separator = " ", const std::string &end_row = "") const;
+    };
+
+    // Compressed sparse column matrix, the column-major twin of SparseCSR.
+    // Cheap to build column by column and to multiply transposed.
+    template <typename T>
+    struct SparseCSC
+    {
+    private:
+        size_t n;
+        size_t m;
+        std::vector<size_t> ptr;
+        std::vector<size_t> idx;
+        std::vector<T> vals;
+
+    public:
+        SparseCSC() : n(0), m(0), ptr(1, 0) {}
+        SparseCSC(size_t rows, size_t cols) : n(rows), m(cols), ptr(cols + 1, 0) {}
+        SparseCSC(size_t rows, size_t cols, const std::vector<Triplet<T>> &triplets);
+        SparseCSC(size_t rows, size_t cols, std::vector<size_t> col_offsets, std::vector<size_t> row_indices, std::vector<T> values);
+        template <size_t rows, size_t cols>
+        explicit SparseCSC(const Matrix<T, rows, cols> &mat) : SparseCSC(SparseCSR<T>(mat).to_csc()) {}
+        explicit SparseCSC(const DynMatrix<T> &mat) : SparseCSC(SparseCSR<T>(mat).to_csc()) {}
+
+        size_t rows() const { return n; }
+        size_t cols() const { return m; }
+        size_t nonzeros() const { return idx.size(); }
+        const std::vector<size_t> &col_offsets() const { return ptr; }
+        const std::vector<size_t> &row_indices() const { return idx; }
+        const std::vector<T> &values() const { return vals; }
+
+        T get(size_t row, size_t col) const;
+
+        DynMatrix<T> to_dense() const { return to_csr().to_dense(); }
+        template <size_t rows, size_t cols>
+        Matrix<T, rows, cols> to_matrix() const { return to_csr().template to_matrix<rows, cols>(); }
+        SparseCSR<T> to_csr() const;
+    };
+
+    inline void sparse_check_offsets(const std::vector<size_t> &ptr, size_t major, size_t minor, const std::vector<size_t> &idx, size_t values)
+    {
+        if (ptr.size() != major + 1 || ptr.front() != 0 || ptr.back() != idx.size() || idx.size() != values)
+            throw MuthExceptionInvalidOperation("inconsistent sparse matrix arrays");
+        for (size_t i = 0; i < major; i++)
+            if (ptr[i] > ptr[i + 1])
+                throw MuthExceptionInvalidOperation("inconsistent sparse matrix arrays");
+        for (size_t k : idx)
+            if (k >= minor)
+                throw MuthOutOfRangeException("sparse entry index out of range");
+    }
+
+    template <typename T>
+    SparseCSR<T>::SparseCSR(size_t rows, size_t cols, const std::vector<Triplet<T>> &triplets) : n(rows), m(cols)
+    {
+        sparse_compress(rows, cols, triplets, true, ptr, idx, vals);
+    }
+
+    // Takes ownership of ready-made arrays; columns must be ascending per row.
+    template <typename T>
+    SparseCSR<T>::SparseCSR(size_t rows, size_t cols, std::vector<size_t> row_offsets, std::vector<size_t> columns, std::vector<T> values)
+        : n(rows), m(cols), ptr(std::move(row_offsets)), idx(std::move(columns)), vals(std::move(values))
+    {
+        sparse_check_offsets(ptr, n, m, idx, vals.size());
+    }
+
+    template <typename T>
+    SparseCSR<T>::SparseCSR(size_t rows, size_t cols, const T *dense) : n(rows), m(cols), ptr(rows + 1, 0)
+    {
+        for (size_t r = 0; r < n; r++)
+        {
+            for (size_t c = 0; c < m; c++)
+            {
+                if (dense[r * m + c] != T(0))
+                {
+                    idx.push_back(c);
+                    vals.push_back(dense[r * m + c]);
+                }
+            }
+            ptr[r + 1] = idx.size();
+        }
+    }
+
+    template <typename T>
+    T SparseCSR<T>::get(size_t row, size_t col) const
+    {
+        if (row >= n || col >= m)
+            throw MuthOutOfRangeException("matrix index out of range");
+        auto first = idx.begin() + ptr[row], last = idx.begin() + ptr[row + 1];
+        auto it = std::lower_bound(first, last, col);
+        return it != last && *it == col ? vals[it - idx.begin()] : T(0);
+    }
+
+    template <typename T>
+    DynMatrix<T> SparseCSR<T>::to_dense() const
+    {
+        DynMatrix<T> result(n, m);
+        for (size_t r = 0; r < n; r++)
+            for (size_t k = ptr[r]; k < ptr[r + 1]; k++)
+                result[r][idx[k]] = vals[k];
+        return result;
+    }
+
+    template <typename T>
+    template <size_t rows, size_t cols>
+    Matrix<T, rows, cols> SparseCSR<T>::to_matrix() const
+    {
+        if (rows != n || cols != m)
+            throw MuthExceptionInvalidOperation("matrix shapes do not match");
+        Matrix<T, rows, cols> result;
+        for (size_t r = 0; r < n; r++)
+            for (size_t k = ptr[r]; k < ptr[r + 1]; k++)
+                result[r][idx[k]] = vals[k];
+        return result;
+    }
+
+    template <typename T>
+    SparseCSC<T> SparseCSR<T>::to_csc() const
+    {
+        std::vector<size_t> out_ptr, out_idx;
+        std::vector<T> out_vals;
+        sparse_transpose(n, m, ptr, idx, vals, out_ptr, out_idx, out_vals);
+        return SparseCSC<T>(n, m, std::move(out_ptr), std::move(out_idx), std::move(out_vals));
+    }
+
+    template <typename T>
+    SparseCSR<T> SparseCSR<T>::transpose() const
+    {
+        std::vector<size_t> out_ptr, out_idx;
+        std::vector<T> out_vals;
+        sparse_transpose(n, m, ptr, idx, vals, out_ptr, out_idx, out_vals);
+        return SparseCSR<T>(m, n, std::move(out_ptr), std::move(out_idx), std::move(out_vals));
+    }
+
+    template <typename T>
+    std::string SparseCSR<T>::to_string(const std::string &separator /*= " "*/, const std::string &end_row /*= ""*/) const
+    {
+        std::stringstream ss;
+        for (size_t r = 0; r < n; r++)
+        {
+            for (size_t k = ptr[r]; k < ptr[r + 1]; k++)
+                ss << "(" << r << "," << idx[k] << ")=" << vals[k] << separator;
+            ss << end_row;
+        }
+        return ss.str();
+    }
+
+    template <typename T>
+    SparseCSC<T>::SparseCSC(size_t rows, size_t cols, const std::vector<Triplet<T>> &triplets) : n(rows), m(cols)
+    {
+        sparse_compress(rows, cols, triplets, false, ptr, idx, vals);
+    }
+
+    // Takes ownership of ready-made arrays; rows must be ascending per column.
+    template <typename T>
+    SparseCSC<T>::SparseCSC(size_t rows, size_t cols, std::vector<size_t> col_offsets, std::vector<size_t> row_indices, std::vector<T> values)
+        : n(rows), m(cols), ptr(std::move(col_offsets)), idx(std::move(row_indices)), vals(std::move(values))
+    {
+        sparse_check_offsets(ptr, m, n, idx, vals.size());
+    }
+
+    template <typename T>
+    T SparseCSC<T>::get(size_t row, size_t col) const
+    {
+        if (row >= n || col >= m)
+            throw MuthOutOfRangeException("matrix index out of range");
+        auto first = idx.begin() + ptr[col], last = idx.begin() + ptr[col + 1];
+        auto it = std::lower_bound(first, last, row);
+        return it != last && *it == row ? vals[it - idx.begin()] : T(0);
+    }
+
+    template <typename T>
+    SparseCSR<T> SparseCSC<T>::to_csr() const
+    {
+        std::vector<size_t> out_ptr, out_idx;
+        std::vector<T> out_vals;
+        sparse_transpose(m, n, ptr, idx, vals, out_ptr, out_idx, out_vals);
+        return SparseCSR<T>(n, m, std::move(out_ptr), std::move(out_idx), std::move(out_vals));
+    }
+
+    // y = A x for a CSR matrix; one dot product per row, rows split across
+    // the pool once nnz reaches parallel_config().sparse_min.
+    template <typename T>
+    void spmv(const SparseCSR<T> &a, const T *x, T *y)
+    {
+        const size_t *ptr = a.row_offsets().data();
+        const size_t *idx = a.columns().data();
+        const T *vals = a.values().data();
+        const size_t cost = a.rows() ? a.nonzeros() / a.rows() + 1 : 1;
+        parallel_for(0, a.rows(), cost, parallel_config().sparse_min, [&](size_t lo, size_t hi) {
+            for (size_t r = lo; r < hi; r++)
+            {
+                T sum = T(0);
+                for (size_t k = ptr[r]; k < ptr[r + 1]; k++)
+                    sum += vals[k] * x[idx[k]];
+                y[r] = sum;
+            }
+        });
+    }
+
+    // y = A x for a CSC matrix: scatters column by column, so it stays serial.
+    template <typename T>
+    void spmv(const SparseCSC<T> &a, const T *x, T *y)
+    {
+        const size_t *ptr = a.col_offsets().data();
+        const size_t *idx = a.row_indices().data();
+        const T *vals = a.values().data();
+        std::fill_n(y, a.rows(), T(0));
+        for (size_t c = 0; c < a.cols(); c++)
+        {
+            const T xc = x[c];
+            for (size_t k = ptr[c]; k < ptr[c + 1]; k++)
+                y[idx[k]] += vals[k] * xc;
+        }
+    }
+
+    // c(n x w) = A b(m x w), dense row-major with leading dimensions. Every
+    // stored a_rk adds a scaled row of b to row r of c, so the inner loop is
+    // unit-stride over both dense operands.
+    template <typename T>
+    void spmm(const SparseCSR<T> &a, size_t w, const T *b, size_t ldb, T *c, size_t ldc)
+    {
+        const size_t *ptr = a.row_offsets().data();
+        const size_t *idx = a.columns().data();
+        const T *vals = a.values().data();
+        const size_t cost = (a.rows() ? a.nonzeros() / a.rows() + 1 : 1) * w;
+        parallel_for(0, a.rows(), cost, parallel_config().sparse_min, [&](size_t lo, size_t hi) {
+            for (size_t r = lo; r < hi; r++)
+            {
+                T *c_row = c + r * ldc;
+                std::fill_n(c_row, w, T(0));
+                for (size_t k = ptr[r]; k < ptr[r + 1]; k++)
+                {
+                    const T a_rk = vals[k];
+                    const T *b_row = b + idx[k] * ldb;
+                    for (size_t col = 0; col < w; col++)
+                        c_row[col] += a_rk * b_row[col];
+                }
+            }
+        });
+    }
+
+    // Same product for a CSC matrix: every stored a_rk of column k adds a
+    // scaled row k of b to row r of c. Rows of c receive scattered updates,
+    // so the pool splits the columns of b instead.
+    template <typename T>
+    void spmm(const SparseCSC<T> &a, size_t w, const T *b, size_t ldb, T *c, size_t ldc)
+    {
+        const size_t *ptr = a.col_offsets().data();
+        const size_t *idx = a.row_indices().data();
+        const T *vals = a.values().data();
+        parallel_for(0, w, a.nonzeros() + a.rows(), parallel_config().sparse_min, [&](size_t lo, size_t hi) {
+            for (size_t r = 0; r < a.rows(); r++)
+                std::fill(c + r * ldc + lo, c + r * ldc + hi, T(0));
+            for (size_t k = 0; k < a.cols(); k++)
+            {
+                const T *b_row = b + k * ldb;
+                for (size_t p = ptr[k]; p < ptr[k + 1]; p++)
+                {
+                    const T a_rk = vals[p];
+                    T *c_row = c + idx[p] * ldc;
+                    for (size_t col = lo; col < hi; col++)
+                        c_row[col] += a_rk * b_row[col];
+                }
+            }
+        });
+    }
+
+    template <typename T>
+    DynVector<T> operator*(const SparseCSR<T> &a, const DynVector<T> &x)
+    {
+        if (a.cols() != x.size())
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        DynVector<T> y(a.rows());
+        spmv(a, x.elements, y.elements);
+        return y;
+    }
+
+    template <typename T>
+    DynVector<T> operator*(const SparseCSC<T> &a, const DynVector<T> &x)
+    {
+        if (a.cols() != x.size())
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        DynVector<T> y(a.rows());
+        spmv(a, x.elements, y.elements);
+        return y;
+    }
+
+    // SpMV into a fixed-size Vector, e.g. spmv<6>(a, x); the stored shape is
+    // checked at runtime.
+    template <size_t n, typename T, size_t m>
+    Vector<T, n> spmv(const SparseCSR<T> &a, const Vector<T, m> &x)
+    {
+        if (a.rows() != n || a.cols() != m)
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        Vector<T, n> y;
+        spmv(a, x.elements, y.elements);
+        return y;
+    }
+
+    template <typename T>
+    DynMatrix<T> operator*(const SparseCSR<T> &a, const DynMatrix<T> &b)
+    {
+        if (a.cols() != b.rows())
+            throw MuthExceptionInvalidOperation("matrix shapes do not match");
+        DynMatrix<T> c(a.rows(), b.cols());
+        spmm(a, b.cols(), b.elements, b.cols(), c.elements, c.cols());
+        return c;
+    }
+
+    template <typename T>
+    DynMatrix<T> operator*(const SparseCSC<T> &a, const DynMatrix<T> &b)
+    {
+        if (a.cols() != b.rows())
+            throw MuthExceptionInvalidOperation("matrix shapes do not match");
+        DynMatrix<T> c(a.rows(), b.cols());
+        spmm(a, b.cols(), b.elements, b.cols(), c.elements, c.cols());
+        return c;
+    }
+
+    template <typename T>
+    std::ostream &operator<<(std::ostream &out, const SparseCSR<T> &mat)
+    {
+        return out << mat.to_string();
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
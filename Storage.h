@@ -0,0 +1,189 @@
+#ifndef MUTH_STORAGE_H
+#define MUTH_STORAGE_H
+
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "Arena.h"
+
+// Fixed-size element blocks up to this many bytes are kept inside the object.
+#ifndef MUTH_INLINE_STORAGE_LIMIT
+#define MUTH_INLINE_STORAGE_LIMIT 1024
+#endif
+
+// Alignment of heap element blocks (HeapStorage and DynStorage).
+#ifndef MUTH_DYN_STORAGE_ALIGNMENT
+#define MUTH_DYN_STORAGE_ALIGNMENT 64
+#endif
+
+namespace Muth
+{
+
+    template <typename T, size_t size>
+    struct StorageAlignment
+    {
+        static constexpr size_t bytes = size * sizeof(T);
+        static constexpr size_t simd = bytes % 32 == 0 ? 32 : (bytes % 16 == 0 ? 16 : alignof(T));
+        static constexpr size_t value = simd > alignof(T) ? simd : alignof(T);
+    };
+
+    // In-object buffer: trivially copyable, no allocation.
+    template <typename T, size_t size>
+    struct InlineStorage
+    {
+        alignas(StorageAlignment<T, size>::value) T elements[size];
+    };
+
+    // Element blocks on the heap: from the thread's current arena inside an
+    // ArenaScope, otherwise from the global allocator, aligned to
+    // MUTH_DYN_STORAGE_ALIGNMENT either way. Storages remember the arena
+    // their block came from; release() leaves arena memory to the scope.
+    template <typename T>
+    struct HeapAllocation
+    {
+        static constexpr size_t alignment = MUTH_DYN_STORAGE_ALIGNMENT > alignof(T) ? MUTH_DYN_STORAGE_ALIGNMENT : alignof(T);
+
+        static T *allocate(size_t count, Arena *arena)
+        {
+            if (!count)
+                return nullptr;
+            if (arena)
+                return static_cast<T *>(arena->allocate(count * sizeof(T), alignment));
+            return static_cast<T *>(::operator new[](count * sizeof(T), std::align_val_t(alignment)));
+        }
+
+        static void release(T *elements, size_t count, Arena *arena)
+        {
+            if (!elements)
+                return;
+            std::destroy_n(elements, count);
+            if (!arena)
+                ::operator delete[](elements, std::align_val_t(alignment));
+        }
+    };
+
+    // Heap buffer with deep copy and pointer-stealing move.
+    template <typename T, size_t size>
+    struct HeapStorage
+    {
+        Arena *arena;
+        T *elements;
+
+        HeapStorage() : arena(current_arena()), elements(HeapAllocation<T>::allocate(size, arena))
+        {
+            std::uninitialized_value_construct_n(elements, size);
+        }
+        HeapStorage(const HeapStorage &src) : arena(current_arena()), elements(HeapAllocation<T>::allocate(size, arena))
+        {
+            std::uninitialized_copy_n(src.elements, size, elements);
+        }
+        HeapStorage(HeapStorage &&r_value) noexcept : arena(r_value.arena), elements(r_value.elements)
+        {
+            r_value.elements = nullptr;
+        }
+        ~HeapStorage() { HeapAllocation<T>::release(elements, size, arena); }
+
+        HeapStorage &operator=(const HeapStorage &src)
+        {
+            if (this != &src)
+            {
+                if (!elements)
+                {
+                    arena = current_arena();
+                    elements = HeapAllocation<T>::allocate(size, arena);
+                    std::uninitialized_copy_n(src.elements, size, elements);
+                }
+                else
+                    std::copy_n(src.elements, size, elements);
+            }
+            return *this;
+        }
+        // Blocks are only exchanged between storages of the same arena. A
+        // block from another arena could be rewound while this object is
+        // still alive, so it is copied into this storage's own block instead.
+        HeapStorage &operator=(HeapStorage &&other)
+        {
+            if (arena == other.arena)
+            {
+                std::swap(elements, other.elements);
+            }
+            else if (other.elements)
+            {
+                if (!elements)
+                {
+                    elements = HeapAllocation<T>::allocate(size, arena);
+                    std::uninitialized_move_n(other.elements, size, elements);
+                }
+                else
+                    std::move(other.elements, other.elements + size, elements);
+            }
+            return *this;
+        }
+    };
+
+    // Specialize to force a policy for a given element type and size.
+    template <typename T, size_t size>
+    struct StorageSelector
+    {
+        using type = typename std::conditional<(size * sizeof(T) <= MUTH_INLINE_STORAGE_LIMIT),
+                                               InlineStorage<T, size>,
+                                               HeapStorage<T, size>>::type;
+    };
+
+    // Runtime-sized, over-aligned heap buffer. Move-only: copies of large
+    // blocks have to be asked for explicitly.
+    template <typename T>
+    struct DynStorage
+    {
+        static constexpr size_t alignment = HeapAllocation<T>::alignment;
+
+        Arena *arena = nullptr;
+        T *elements = nullptr;
+        size_t capacity = 0;
+
+        DynStorage() = default;
+        explicit DynStorage(size_t count) : arena(current_arena()), elements(HeapAllocation<T>::allocate(count, arena)), capacity(count)
+        {
+            std::uninitialized_value_construct_n(elements, count);
+        }
+        DynStorage(const DynStorage &src) = delete;
+        DynStorage(DynStorage &&r_value) noexcept : arena(r_value.arena), elements(r_value.elements), capacity(r_value.capacity)
+        {
+            r_value.elements = nullptr;
+            r_value.capacity = 0;
+        }
+        ~DynStorage() { HeapAllocation<T>::release(elements, capacity, arena); }
+
+        DynStorage &operator=(const DynStorage &src) = delete;
+        // Same arena rule as HeapStorage: a block from another arena is
+        // copied into one of this storage's arena, reallocated if the
+        // capacities differ.
+        DynStorage &operator=(DynStorage &&other)
+        {
+            if (arena == other.arena)
+            {
+                std::swap(elements, other.elements);
+                std::swap(capacity, other.capacity);
+            }
+            else if (capacity == other.capacity)
+            {
+                std::move(other.elements, other.elements + capacity, elements);
+            }
+            else
+            {
+                T *block = HeapAllocation<T>::allocate(other.capacity, arena);
+                std::uninitialized_move_n(other.elements, other.capacity, block);
+                HeapAllocation<T>::release(elements, capacity, arena);
+                elements = block;
+                capacity = other.capacity;
+            }
+            return *this;
+        }
+    };
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
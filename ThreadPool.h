@@ -0,0 +1,266 @@
+#ifndef MUTH_THREAD_POOL_H
+#define MUTH_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Default thresholds of the opt-in parallel mode, in multiply-adds.
+#ifndef MUTH_PARALLEL_GEMM_MIN
+#define MUTH_PARALLEL_GEMM_MIN (192 * 192 * 192)
+#endif
+#ifndef MUTH_PARALLEL_ELIMINATE_MIN
+#define MUTH_PARALLEL_ELIMINATE_MIN (256 * 256)
+#endif
+#ifndef MUTH_PARALLEL_SPARSE_MIN
+#define MUTH_PARALLEL_SPARSE_MIN (128 * 1024)
+#endif
+#ifndef MUTH_PARALLEL_BATCH_MIN
+#define MUTH_PARALLEL_BATCH_MIN (256 * 1024)
+#endif
+
+namespace Muth
+{
+
+    // Parallel execution is off unless enabled here. Work below the thresholds
+    // always runs on the calling thread.
+    struct ParallelConfig
+    {
+        bool enabled = false;
+        size_t gemm_min = MUTH_PARALLEL_GEMM_MIN;
+        size_t eliminate_min = MUTH_PARALLEL_ELIMINATE_MIN;
+        size_t sparse_min = MUTH_PARALLEL_SPARSE_MIN;
+        size_t batch_min = MUTH_PARALLEL_BATCH_MIN;
+    };
+
+    inline ParallelConfig &parallel_config()
+    {
+        static ParallelConfig config;
+        return config;
+    }
+
+    // Work-stealing pool: every worker owns a deque, pops its own work from the
+    // back and steals from the front of the others when it runs dry. Threads
+    // waiting in parallel_for run queued tasks instead of blocking, so nested
+    // parallel loops cannot deadlock.
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        explicit ThreadPool(size_t threads = default_threads());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // Number of worker threads; callers of parallel_for add one more.
+        size_t size() const { return workers.size(); }
+
+        void submit(Task task);
+
+        // Calls fn(lo, hi) on chunks of at most grain indices covering
+        // [begin, end) and returns once all of them finished. The first
+        // exception thrown by a chunk is rethrown here.
+        template <typename F>
+        void parallel_for(size_t begin, size_t end, size_t grain, F &&fn);
+
+        static ThreadPool &instance();
+        static size_t default_threads();
+
+    private:
+        struct Queue
+        {
+            std::mutex lock;
+            std::deque<Task> tasks;
+        };
+
+        bool try_pop(size_t home, Task &task);
+        void run(size_t index);
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<size_t> next_queue{0};
+        std::atomic<size_t> pending{0};
+        std::atomic<bool> stopping{false};
+        std::mutex sleep_lock;
+        std::condition_variable wake;
+
+        static inline thread_local ThreadPool *current_pool = nullptr;
+        static inline thread_local size_t current_index = 0;
+    };
+
+    inline ThreadPool::ThreadPool(size_t threads)
+    {
+        const size_t queue_count = threads ? threads : 1;
+        for (size_t i = 0; i < queue_count; i++)
+            queues.emplace_back(new Queue);
+        for (size_t i = 0; i < threads; i++)
+            workers.emplace_back(&ThreadPool::run, this, i);
+    }
+
+    inline ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    inline size_t ThreadPool::default_threads()
+    {
+        const size_t hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 0;
+    }
+
+    inline ThreadPool &ThreadPool::instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    inline void ThreadPool::submit(Task task)
+    {
+        const size_t index = current_pool == this ? current_index : next_queue++ % queues.size();
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            pending++;
+        }
+        {
+            std::lock_guard<std::mutex> guard(queues[index]->lock);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    inline bool ThreadPool::try_pop(size_t home, Task &task)
+    {
+        {
+            Queue &own = *queues[home];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                pending--;
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < queues.size(); offset++)
+        {
+            Queue &victim = *queues[(home + offset) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                pending--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline void ThreadPool::run(size_t index)
+    {
+        current_pool = this;
+        current_index = index;
+        Task task;
+        while (true)
+        {
+            if (try_pop(index, task))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            wake.wait(guard, [this] { return stopping || pending > 0; });
+            if (stopping && pending == 0)
+                return;
+        }
+    }
+
+    template <typename F>
+    void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, F &&fn)
+    {
+        if (begin >= end)
+            return;
+        if (grain == 0)
+            grain = 1;
+        const size_t chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1 || workers.empty())
+        {
+            fn(begin, end);
+            return;
+        }
+
+        std::atomic<size_t> remaining{chunks};
+        std::exception_ptr error;
+        std::mutex error_lock;
+        for (size_t lo = begin; lo < end; lo += grain)
+        {
+            const size_t hi = lo + grain < end ? lo + grain : end;
+            submit([&, lo, hi] {
+                try
+                {
+                    fn(lo, hi);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> guard(error_lock);
+                    if (!error)
+                        error = std::current_exception();
+                }
+                remaining--;
+            });
+        }
+
+        const size_t home = current_pool == this ? current_index : 0;
+        Task task;
+        while (remaining > 0)
+        {
+            if (try_pop(home, task))
+            {
+                task();
+                task = nullptr;
+            }
+            else
+                std::this_thread::yield();
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // Runs fn(lo, hi) over [begin, end). Uses the shared pool when parallel
+    // execution is enabled and (end - begin) * cost reaches min_work, otherwise
+    // makes a single call on this thread.
+    template <typename F>
+    inline void parallel_for(size_t begin, size_t end, size_t cost, size_t min_work, F &&fn)
+    {
+        if (begin >= end)
+            return;
+        const size_t count = end - begin;
+        if (!parallel_config().enabled || count * cost < min_work)
+        {
+            fn(begin, end);
+            return;
+        }
+        ThreadPool &pool = ThreadPool::instance();
+        const size_t chunks = (pool.size() + 1) * 4;
+        pool.parallel_for(begin, end, (count + chunks - 1) / chunks, fn);
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
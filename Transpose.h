@@ -0,0 +1,117 @@
+#ifndef MUTH_TRANSPOSE_H
+#define MUTH_TRANSPOSE_H
+
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+
+#include "Simd.h"
+
+// Edge of the square blocks a transpose is split into. A block of source
+// rows and the matching destination rows should fit in L1 together.
+#ifndef MUTH_TRANSPOSE_BLOCK
+#define MUTH_TRANSPOSE_BLOCK 64
+#endif
+
+namespace Muth
+{
+
+    constexpr size_t transpose_nb = (MUTH_TRANSPOSE_BLOCK + 15) / 16 * 16;
+
+    // Hint that the cache line at p is about to be written.
+    inline void prefetch_write(const void *p)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p, 1);
+#elif defined(MUTH_SIMD_SSE)
+        _mm_prefetch(static_cast<const char *>(p), _MM_HINT_T0);
+#endif
+    }
+
+    // Transposes rows [r0, r1) x columns [c0, c1) of a into b, in 4x4 tiles
+    // where they fit and element by element along the ragged edges.
+    template <typename T>
+    inline void transpose_tiles(size_t r0, size_t r1, size_t c0, size_t c1, const T *a, size_t lda, T *b, size_t ldb)
+    {
+        size_t r = r0;
+        for (; r + 4 <= r1; r += 4)
+        {
+            size_t c = c0;
+            for (; c + 4 <= c1; c += 4)
+                simd_transpose4(a + r * lda + c, lda, b + c * ldb + r, ldb);
+            for (; c < c1; c++)
+                for (size_t i = r; i < r + 4; i++)
+                    b[c * ldb + i] = a[i * lda + c];
+        }
+        for (; r < r1; r++)
+            for (size_t c = c0; c < c1; c++)
+                b[c * ldb + r] = a[r * lda + c];
+    }
+
+    // b(m x n) = a(n x m)^T, row-major with leading dimensions; a and b must
+    // not overlap. Walking block by block keeps both the rows read and the
+    // rows written in cache, so large transposes run at memory bandwidth
+    // instead of missing on every store. Inside a block, tiles one cache
+    // line wide are written destination row by destination row, and the
+    // lines of the next tile are prefetched for writing: at power-of-two
+    // strides the destination rows share a cache set and would otherwise
+    // each miss.
+    template <typename T>
+    void transpose(size_t n, size_t m, const T *a, size_t lda, T *b, size_t ldb)
+    {
+        constexpr size_t line = 64 / sizeof(T) > 4 ? 64 / sizeof(T) : 4;
+        for (size_t r0 = 0; r0 < n; r0 += transpose_nb)
+        {
+            const size_t r1 = std::min(n, r0 + transpose_nb);
+            for (size_t c0 = 0; c0 < m; c0 += transpose_nb)
+            {
+                const size_t c1 = std::min(m, c0 + transpose_nb);
+                for (size_t c = c0; c < c1; c += line)
+                    for (size_t r = r0; r < r1; r += line)
+                    {
+                        if (r + line < r1)
+                            for (size_t i = c; i < std::min(c1, c + line); i++)
+                                prefetch_write(b + i * ldb + r + line);
+                        transpose_tiles(r, std::min(r1, r + line), c, std::min(c1, c + line), a, lda, b, ldb);
+                    }
+            }
+        }
+    }
+
+    // a(n x n) = a^T in place. Each pair of mirrored 4x4 tiles is swapped
+    // through one tile-sized buffer, block by block; rows and columns past
+    // the last whole tile are swapped element by element.
+    template <typename T>
+    void transpose_in_place(size_t n, T *a, size_t lda)
+    {
+        const size_t n4 = n / 4 * 4;
+        T tile[16];
+        for (size_t bi = 0; bi < n4; bi += transpose_nb)
+        {
+            const size_t bi1 = std::min(n4, bi + transpose_nb);
+            for (size_t bj = bi; bj < n4; bj += transpose_nb)
+            {
+                const size_t bj1 = std::min(n4, bj + transpose_nb);
+                for (size_t i = bi; i < bi1; i += 4)
+                {
+                    for (size_t j = bi == bj ? i : bj; j < bj1; j += 4)
+                    {
+                        T *upper = a + i * lda + j;
+                        T *lower = a + j * lda + i;
+                        for (size_t r = 0; r < 4; r++)
+                            std::copy_n(lower + r * lda, 4, tile + r * 4);
+                        if (i != j)
+                            simd_transpose4(upper, lda, lower, lda);
+                        simd_transpose4(tile, 4, upper, lda);
+                    }
+                }
+            }
+        }
+        for (size_t r = 0; r < n; r++)
+            for (size_t c = std::max(r + 1, n4); c < n; c++)
+                std::swap(a[r * lda + c], a[c * lda + r]);
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
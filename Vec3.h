@@ -4,23 +4,38 @@
 #include <string>
 #include <sstream>
 
+#include "NumTool.h"
+#include "Simd.h"
+
 namespace Muth
 {
+    // Define MUTH_VEC3_PADDED to give Vec3 a fourth, always-zero lane and
+    // vector-register alignment, so dot / cross / normalized use SIMD kernels.
+#ifdef MUTH_VEC3_PADDED
+    constexpr bool vec3_padded = true;
+#else
+    constexpr bool vec3_padded = false;
+#endif
+
     template<typename T>
-    struct Vec3
+    struct alignas(vec3_padded ? 4 * sizeof(T) : alignof(T)) Vec3
     {   
     public:
         T x;
         T y;
         T z;
+#ifdef MUTH_VEC3_PADDED
+        T w = T(0);
+#endif
 
     public:
-        inline Vec3() : x(0), y(0), z(0) {}
-        inline Vec3(const T &x, const T &y, const T &z) : x(x), y(y), z(z) {}
-        inline Vec3(const T *values) : x(values[0]), y(values[1]), z(values[2]) {}
+        constexpr Vec3() : x(0), y(0), z(0) {}
+        constexpr Vec3(const T &x, const T &y, const T &z) : x(x), y(y), z(z) {}
+        constexpr Vec3(const T *values) : x(values[0]), y(values[1]), z(values[2]) {}
     
     public:
-        T& operator[] (const size_t &idx) { return idx == 0 ? x : (idx == 1 ? y : z); }
+        constexpr T& operator[] (const size_t &idx) { return idx == 0 ? x : (idx == 1 ? y : z); }
+        constexpr const T& operator[] (const size_t &idx) const { return idx == 0 ? x : (idx == 1 ? y : z); }
 
         std::string to_string(const std::string &separator = " ") const
         {
@@ -30,63 +45,80 @@ namespace Muth
         }
 
     public:
-        inline T length_square() const { return x * x + y * y + z * z; }
+        constexpr T length_square() const { return x * x + y * y + z * z; }
         inline T length() const
         {
             if (std::is_same<T, float>::value)
                 return sqrtf(this->length_square());
             return sqrt(this->length_square());
         }
-        inline Vec3<T> normalized() const { return (*this) / this->length(); }
+        inline Vec3<T> normalized() const
+        {
+            if constexpr (vec3_padded && SimdSupport<T, 3>::value)
+            {
+                Vec3<T> result;
+                simd_normalize3(&x, &result.x);
+                return result;
+            }
+            return (*this) / this->length();
+        }
         inline T projection(const Vec3<T> &vec) const { return this->dot(vec) / vec.length(); }
         inline  Vec3<T> projection_vector(const Vec3<T> &vec) const { return vec.normalized() * this->projection(vec); }
-        inline T dot(const Vec3<T> &other) const { return x * other.x + y * other.y + z * other.z; }
+        constexpr T dot(const Vec3<T> &other) const
+        {
+            if constexpr (vec3_padded && SimdSupport<T, 3>::value)
+            {
+                if (!is_constant_evaluated())
+                    return simd_dot3(&x, &other.x);
+            }
+            return x * other.x + y * other.y + z * other.z;
+        }
     
     public:
-        inline Vec3<T> &operator+= (const Vec3<T> &other) { *this = (*this) + other; return *this; }
-        inline Vec3<T> &operator-= (const Vec3<T> &other) { *this = (*this) - other; return *this; }
-        inline Vec3<T> &operator*= (T lambda) { *this = (*this) * lambda; return *this; }
-        inline Vec3<T> &operator/= (T lambda) { *this = (*this) / lambda; return *this; }
+        constexpr Vec3<T> &operator+= (const Vec3<T> &other) { *this = (*this) + other; return *this; }
+        constexpr Vec3<T> &operator-= (const Vec3<T> &other) { *this = (*this) - other; return *this; }
+        constexpr Vec3<T> &operator*= (T lambda) { *this = (*this) * lambda; return *this; }
+        constexpr Vec3<T> &operator/= (T lambda) { *this = (*this) / lambda; return *this; }
     };
 
     template <typename T>
-    inline Vec3<T> operator+(const Vec3<T> &left, const Vec3<T> &right)
+    constexpr Vec3<T> operator+(const Vec3<T> &left, const Vec3<T> &right)
     {
         return { left.x + right.x, left.y + right.y, left.z + right.z };
     }
 
     template <typename T>
-    inline Vec3<T> operator-(const Vec3<T> &left, const Vec3<T> &right)
+    constexpr Vec3<T> operator-(const Vec3<T> &left, const Vec3<T> &right)
     {
         return { left.x - right.x, left.y - right.y, left.z - right.z };
     }
 
     template <typename T>
-    inline Vec3<T> operator*(const Vec3<T> &vec, T lambda)
+    constexpr Vec3<T> operator*(const Vec3<T> &vec, T lambda)
     {
         return { vec.x * lambda, vec.y * lambda, vec.z * lambda };
     }
 
     template <typename T>
-    inline Vec3<T> operator/(const Vec3<T> &vec, T lambda)
+    constexpr Vec3<T> operator/(const Vec3<T> &vec, T lambda)
     {
         return { vec.x / lambda, vec.y / lambda, vec.z / lambda };
     }
 
     template <typename T>
-    inline Vec3<T> operator*(T lambda, const Vec3<T> &vec)
+    constexpr Vec3<T> operator*(T lambda, const Vec3<T> &vec)
     {
         return { vec.x * lambda, vec.y * lambda, vec.z * lambda };
     }
 
     template <typename T>
-    inline T operator*(const Vec3<T> &left, const Vec3<T> &right)
+    constexpr T operator*(const Vec3<T> &left, const Vec3<T> &right)
     {
         return left.dot(right);
     }
 
     template <typename T>
-    inline Vec3<T> operator-(const Vec3<T> &vec)
+    constexpr Vec3<T> operator-(const Vec3<T> &vec)
     {
         return { -vec.x, -vec.y, -vec.z };
     }
@@ -98,8 +130,17 @@ namespace Muth
     }
 
     template<typename T>
-    inline Vec3<T> cross(Vec3<T> left, Vec3<T> right)
+    constexpr Vec3<T> cross(Vec3<T> left, Vec3<T> right)
     {
+        if constexpr (vec3_padded && SimdSupport<T, 3>::value)
+        {
+            if (!is_constant_evaluated())
+            {
+                Vec3<T> result;
+                simd_cross3(&left.x, &right.x, &result.x);
+                return result;
+            }
+        }
         return {
             left[1] * right[2] - left[2] * right[1],
             left[2] * right[0] - left[0] * right[2],
@@ -0,0 +1,391 @@
+#ifndef MUTH_VEC_BATCH_H
+#define MUTH_VEC_BATCH_H
+
+#include <cmath>
+#include <vector>
+
+#include "MuthException.h"
+#include "Vec2.h"
+#include "Vec3.h"
+#include "Matrix.h"
+
+namespace Muth
+{
+
+    // Structure-of-arrays storage for many Vec2 / Vec3: one contiguous array per
+    // component, so the bulk operations below are plain unit-stride loops the
+    // compiler vectorizes. Outputs are resized to fit and may alias the inputs.
+
+    template <typename T>
+    struct Vec2Batch
+    {
+    public:
+        std::vector<T> x;
+        std::vector<T> y;
+
+    public:
+        Vec2Batch() = default;
+        explicit Vec2Batch(size_t count) : x(count), y(count) {}
+        Vec2Batch(const Vec2<T> *values, size_t count);
+        Vec2Batch(const std::vector<Vec2<T>> &values) : Vec2Batch(values.data(), values.size()) {}
+
+    public:
+        size_t size() const { return x.size(); }
+        void resize(size_t count) { x.resize(count); y.resize(count); }
+
+        Vec2<T> get(size_t idx) const { return { x[idx], y[idx] }; }
+        void set(size_t idx, const Vec2<T> &vec) { x[idx] = vec.x; y[idx] = vec.y; }
+
+        void to_aos(Vec2<T> *out) const;
+        std::vector<Vec2<T>> to_aos() const;
+    };
+
+    template <typename T>
+    struct Vec3Batch
+    {
+    public:
+        std::vector<T> x;
+        std::vector<T> y;
+        std::vector<T> z;
+
+    public:
+        Vec3Batch() = default;
+        explicit Vec3Batch(size_t count) : x(count), y(count), z(count) {}
+        Vec3Batch(const Vec3<T> *values, size_t count);
+        Vec3Batch(const std::vector<Vec3<T>> &values) : Vec3Batch(values.data(), values.size()) {}
+
+    public:
+        size_t size() const { return x.size(); }
+        void resize(size_t count) { x.resize(count); y.resize(count); z.resize(count); }
+
+        Vec3<T> get(size_t idx) const { return { x[idx], y[idx], z[idx] }; }
+        void set(size_t idx, const Vec3<T> &vec) { x[idx] = vec.x; y[idx] = vec.y; z[idx] = vec.z; }
+
+        void to_aos(Vec3<T> *out) const;
+        std::vector<Vec3<T>> to_aos() const;
+    };
+
+    template <typename T>
+    Vec2Batch<T>::Vec2Batch(const Vec2<T> *values, size_t count) : x(count), y(count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            x[i] = values[i].x;
+            y[i] = values[i].y;
+        }
+    }
+
+    template <typename T>
+    void Vec2Batch<T>::to_aos(Vec2<T> *out) const
+    {
+        for (size_t i = 0; i < size(); i++)
+            out[i] = { x[i], y[i] };
+    }
+
+    template <typename T>
+    std::vector<Vec2<T>> Vec2Batch<T>::to_aos() const
+    {
+        std::vector<Vec2<T>> result(size());
+        to_aos(result.data());
+        return result;
+    }
+
+    template <typename T>
+    Vec3Batch<T>::Vec3Batch(const Vec3<T> *values, size_t count) : x(count), y(count), z(count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            x[i] = values[i].x;
+            y[i] = values[i].y;
+            z[i] = values[i].z;
+        }
+    }
+
+    template <typename T>
+    void Vec3Batch<T>::to_aos(Vec3<T> *out) const
+    {
+        for (size_t i = 0; i < size(); i++)
+            out[i] = { x[i], y[i], z[i] };
+    }
+
+    template <typename T>
+    std::vector<Vec3<T>> Vec3Batch<T>::to_aos() const
+    {
+        std::vector<Vec3<T>> result(size());
+        to_aos(result.data());
+        return result;
+    }
+
+    template <typename Left, typename Right>
+    inline void batch_check_size(const Left &left, const Right &right)
+    {
+        if (left.size() != right.size())
+            throw MuthExceptionInvalidOperation("batch sizes do not match");
+    }
+
+    // ---- Vec2Batch ----
+
+    template <typename T>
+    void add(const Vec2Batch<T> &left, const Vec2Batch<T> &right, Vec2Batch<T> &out)
+    {
+        batch_check_size(left, right);
+        const size_t count = left.size();
+        out.resize(count);
+        const T *lx = left.x.data(), *ly = left.y.data(), *rx = right.x.data(), *ry = right.y.data();
+        T *ox = out.x.data(), *oy = out.y.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            ox[i] = lx[i] + rx[i];
+            oy[i] = ly[i] + ry[i];
+        }
+    }
+
+    template <typename T>
+    void subtract(const Vec2Batch<T> &left, const Vec2Batch<T> &right, Vec2Batch<T> &out)
+    {
+        batch_check_size(left, right);
+        const size_t count = left.size();
+        out.resize(count);
+        const T *lx = left.x.data(), *ly = left.y.data(), *rx = right.x.data(), *ry = right.y.data();
+        T *ox = out.x.data(), *oy = out.y.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            ox[i] = lx[i] - rx[i];
+            oy[i] = ly[i] - ry[i];
+        }
+    }
+
+    template <typename T>
+    void scale(const Vec2Batch<T> &vecs, T lambda, Vec2Batch<T> &out)
+    {
+        const size_t count = vecs.size();
+        out.resize(count);
+        const T *vx = vecs.x.data(), *vy = vecs.y.data();
+        T *ox = out.x.data(), *oy = out.y.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            ox[i] = vx[i] * lambda;
+            oy[i] = vy[i] * lambda;
+        }
+    }
+
+    template <typename T>
+    void dot(const Vec2Batch<T> &left, const Vec2Batch<T> &right, std::vector<T> &out)
+    {
+        batch_check_size(left, right);
+        const size_t count = left.size();
+        out.resize(count);
+        const T *lx = left.x.data(), *ly = left.y.data(), *rx = right.x.data(), *ry = right.y.data();
+        T *o = out.data();
+        for (size_t i = 0; i < count; i++)
+            o[i] = lx[i] * rx[i] + ly[i] * ry[i];
+    }
+
+    template <typename T>
+    void cross(const Vec2Batch<T> &left, const Vec2Batch<T> &right, std::vector<T> &out)
+    {
+        batch_check_size(left, right);
+        const size_t count = left.size();
+        out.resize(count);
+        const T *lx = left.x.data(), *ly = left.y.data(), *rx = right.x.data(), *ry = right.y.data();
+        T *o = out.data();
+        for (size_t i = 0; i < count; i++)
+            o[i] = lx[i] * ry[i] - ly[i] * rx[i];
+    }
+
+    template <typename T>
+    void length(const Vec2Batch<T> &vecs, std::vector<T> &out)
+    {
+        const size_t count = vecs.size();
+        out.resize(count);
+        const T *vx = vecs.x.data(), *vy = vecs.y.data();
+        T *o = out.data();
+        for (size_t i = 0; i < count; i++)
+            o[i] = std::sqrt(vx[i] * vx[i] + vy[i] * vy[i]);
+    }
+
+    template <typename T>
+    void normalize(const Vec2Batch<T> &vecs, Vec2Batch<T> &out)
+    {
+        const size_t count = vecs.size();
+        out.resize(count);
+        const T *vx = vecs.x.data(), *vy = vecs.y.data();
+        T *ox = out.x.data(), *oy = out.y.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            const T inv = T(1) / std::sqrt(vx[i] * vx[i] + vy[i] * vy[i]);
+            ox[i] = vx[i] * inv;
+            oy[i] = vy[i] * inv;
+        }
+    }
+
+    template <typename T>
+    void transform(const Mat2<T> &mat, const Vec2Batch<T> &vecs, Vec2Batch<T> &out)
+    {
+        const size_t count = vecs.size();
+        out.resize(count);
+        const T m00 = mat[0][0], m01 = mat[0][1], m10 = mat[1][0], m11 = mat[1][1];
+        const T *vx = vecs.x.data(), *vy = vecs.y.data();
+        T *ox = out.x.data(), *oy = out.y.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            const T px = vx[i], py = vy[i];
+            ox[i] = m00 * px + m01 * py;
+            oy[i] = m10 * px + m11 * py;
+        }
+    }
+
+    // ---- Vec3Batch ----
+
+    template <typename T>
+    void add(const Vec3Batch<T> &left, const Vec3Batch<T> &right, Vec3Batch<T> &out)
+    {
+        batch_check_size(left, right);
+        const size_t count = left.size();
+        out.resize(count);
+        const T *lx = left.x.data(), *ly = left.y.data(), *lz = left.z.data();
+        const T *rx = right.x.data(), *ry = right.y.data(), *rz = right.z.data();
+        T *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            ox[i] = lx[i] + rx[i];
+            oy[i] = ly[i] + ry[i];
+            oz[i] = lz[i] + rz[i];
+        }
+    }
+
+    template <typename T>
+    void subtract(const Vec3Batch<T> &left, const Vec3Batch<T> &right, Vec3Batch<T> &out)
+    {
+        batch_check_size(left, right);
+        const size_t count = left.size();
+        out.resize(count);
+        const T *lx = left.x.data(), *ly = left.y.data(), *lz = left.z.data();
+        const T *rx = right.x.data(), *ry = right.y.data(), *rz = right.z.data();
+        T *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            ox[i] = lx[i] - rx[i];
+            oy[i] = ly[i] - ry[i];
+            oz[i] = lz[i] - rz[i];
+        }
+    }
+
+    template <typename T>
+    void scale(const Vec3Batch<T> &vecs, T lambda, Vec3Batch<T> &out)
+    {
+        const size_t count = vecs.size();
+        out.resize(count);
+        const T *vx = vecs.x.data(), *vy = vecs.y.data(), *vz = vecs.z.data();
+        T *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            ox[i] = vx[i] * lambda;
+            oy[i] = vy[i] * lambda;
+            oz[i] = vz[i] * lambda;
+        }
+    }
+
+    template <typename T>
+    void dot(const Vec3Batch<T> &left, const Vec3Batch<T> &right, std::vector<T> &out)
+    {
+        batch_check_size(left, right);
+        const size_t count = left.size();
+        out.resize(count);
+        const T *lx = left.x.data(), *ly = left.y.data(), *lz = left.z.data();
+        const T *rx = right.x.data(), *ry = right.y.data(), *rz = right.z.data();
+        T *o = out.data();
+        for (size_t i = 0; i < count; i++)
+            o[i] = lx[i] * rx[i] + ly[i] * ry[i] + lz[i] * rz[i];
+    }
+
+    template <typename T>
+    void cross(const Vec3Batch<T> &left, const Vec3Batch<T> &right, Vec3Batch<T> &out)
+    {
+        batch_check_size(left, right);
+        const size_t count = left.size();
+        out.resize(count);
+        const T *lx = left.x.data(), *ly = left.y.data(), *lz = left.z.data();
+        const T *rx = right.x.data(), *ry = right.y.data(), *rz = right.z.data();
+        T *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            const T ax = lx[i], ay = ly[i], az = lz[i];
+            const T bx = rx[i], by = ry[i], bz = rz[i];
+            ox[i] = ay * bz - az * by;
+            oy[i] = az * bx - ax * bz;
+            oz[i] = ax * by - ay * bx;
+        }
+    }
+
+    template <typename T>
+    void length(const Vec3Batch<T> &vecs, std::vector<T> &out)
+    {
+        const size_t count = vecs.size();
+        out.resize(count);
+        const T *vx = vecs.x.data(), *vy = vecs.y.data(), *vz = vecs.z.data();
+        T *o = out.data();
+        for (size_t i = 0; i < count; i++)
+            o[i] = std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+    }
+
+    template <typename T>
+    void normalize(const Vec3Batch<T> &vecs, Vec3Batch<T> &out)
+    {
+        const size_t count = vecs.size();
+        out.resize(count);
+        const T *vx = vecs.x.data(), *vy = vecs.y.data(), *vz = vecs.z.data();
+        T *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            const T inv = T(1) / std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+            ox[i] = vx[i] * inv;
+            oy[i] = vy[i] * inv;
+            oz[i] = vz[i] * inv;
+        }
+    }
+
+    template <typename T>
+    void transform(const Mat3<T> &mat, const Vec3Batch<T> &vecs, Vec3Batch<T> &out)
+    {
+        const size_t count = vecs.size();
+        out.resize(count);
+        const T m00 = mat[0][0], m01 = mat[0][1], m02 = mat[0][2];
+        const T m10 = mat[1][0], m11 = mat[1][1], m12 = mat[1][2];
+        const T m20 = mat[2][0], m21 = mat[2][1], m22 = mat[2][2];
+        const T *vx = vecs.x.data(), *vy = vecs.y.data(), *vz = vecs.z.data();
+        T *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            const T px = vx[i], py = vy[i], pz = vz[i];
+            ox[i] = m00 * px + m01 * py + m02 * pz;
+            oy[i] = m10 * px + m11 * py + m12 * pz;
+            oz[i] = m20 * px + m21 * py + m22 * pz;
+        }
+    }
+
+    // Applies mat to (x, y, z, 1) and divides by the resulting w.
+    template <typename T>
+    void transform(const Mat4<T> &mat, const Vec3Batch<T> &vecs, Vec3Batch<T> &out)
+    {
+        const size_t count = vecs.size();
+        out.resize(count);
+        const T m00 = mat[0][0], m01 = mat[0][1], m02 = mat[0][2], m03 = mat[0][3];
+        const T m10 = mat[1][0], m11 = mat[1][1], m12 = mat[1][2], m13 = mat[1][3];
+        const T m20 = mat[2][0], m21 = mat[2][1], m22 = mat[2][2], m23 = mat[2][3];
+        const T m30 = mat[3][0], m31 = mat[3][1], m32 = mat[3][2], m33 = mat[3][3];
+        const T *vx = vecs.x.data(), *vy = vecs.y.data(), *vz = vecs.z.data();
+        T *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            const T px = vx[i], py = vy[i], pz = vz[i];
+            const T inv_w = T(1) / (m30 * px + m31 * py + m32 * pz + m33);
+            ox[i] = (m00 * px + m01 * py + m02 * pz + m03) * inv_w;
+            oy[i] = (m10 * px + m11 * py + m12 * pz + m13) * inv_w;
+            oz[i] = (m20 * px + m21 * py + m22 * pz + m23) * inv_w;
+        }
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
@@ -3,88 +3,107 @@
 
 #include <string>
 #include <sstream>
+#include "NumTool.h"
 #include "MuthException.h"
+#include "Expression.h"
+#include "Storage.h"
 #include "Vec2.h"
 #include "Vec3.h"
 
 namespace Muth
 {
     template <typename T, size_t n>
-    struct Vector
+    struct Vector : public StorageSelector<T, n>::type
     {
-        T *elements;
+        using Storage = typename StorageSelector<T, n>::type;
+        using Storage::elements;
 
     public:
-        Vector();
-        Vector(const Vector<T, n> &src);
-        Vector(const T *values);
-        Vector(const std::initializer_list<T> &values);
-        Vector(Vector<T, n> &&r_value);
-        ~Vector();
+        constexpr Vector();
+        Vector(const Vector<T, n> &src) = default;
+        constexpr Vector(const T *values);
+        constexpr Vector(const std::initializer_list<T> &values);
+        Vector(Vector<T, n> &&r_value) = default;
+        template <typename E, typename = EnableIfNodeOf<E, Vector<T, n>>>
+        constexpr Vector(const E &expr);
+        ~Vector() = default;
     
     public:
-        T& operator[] (const size_t &idx) const;
+        constexpr T& operator[] (const size_t &idx);
+        constexpr const T& operator[] (const size_t &idx) const;
 
         std::string to_string(const std::string &separator = " ") const;
 
     public:
-        T length_square() const;
+        template <typename Acc = accumulator_t<T>>
+        constexpr Acc length_square() const;
         T length() const;
         Vector<T, n> normalized() const;
         T projection(const Vector<T, n> &vec) const;
         Vector<T, n> projection_vector(const Vector<T, n> &vec) const;
-        T dot(const Vector<T, n> &other) const;
+        template <typename Acc = accumulator_t<T>>
+        constexpr Acc dot(const Vector<T, n> &other) const;
     
     public:
-        Vector<T, n> &operator= (const Vector<T, n> &src);
-        Vector<T, n> &operator+= (const Vector<T, n> &other);
-        Vector<T, n> &operator-= (const Vector<T, n> &other);
-        Vector<T, n> &operator*= (T lambda);
-        Vector<T, n> &operator/= (T lambda);
+        Vector<T, n> &operator= (const Vector<T, n> &src) = default;
+        Vector<T, n> &operator= (Vector<T, n> &&other) = default;
+        template <typename E, typename = EnableIfNodeOf<E, Vector<T, n>>>
+        constexpr Vector<T, n> &operator= (const E &expr);
+        template <typename E, typename = EnableIfExprOf<E, Vector<T, n>>>
+        constexpr Vector<T, n> &operator+= (const E &other);
+        template <typename E, typename = EnableIfExprOf<E, Vector<T, n>>>
+        constexpr Vector<T, n> &operator-= (const E &other);
+        constexpr Vector<T, n> &operator*= (T lambda);
+        constexpr Vector<T, n> &operator/= (T lambda);
     };
 
     template <typename T, size_t n>
-    inline Vector<T, n>::Vector()
+    struct ExprTraits<Vector<T, n>>
     {
-        elements = new T[n];
-    }
+        static constexpr bool is_expr = true;
+        static constexpr bool leaf = true;
+        using value_type = T;
+        using result_type = Vector<T, n>;
+        static constexpr size_t size = n;
+        static constexpr const T &at(const Vector<T, n> &vec, size_t i) { return vec.elements[i]; }
+    };
 
     template <typename T, size_t n>
-    inline Vector<T, n>::Vector(const Vector<T, n> &src)
+    constexpr Vector<T, n>::Vector() : Storage()
     {
-        elements = new T[n]{};
-        memcpy(elements, src.elements, n * sizeof(T));
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n>::Vector(const T *values)
+    constexpr Vector<T, n>::Vector(const T *values) : Storage()
     {
-        elements = new T[n]{};
-        memcpy(elements, values, n * sizeof(T));
+        for (size_t i = 0; i < n; i++)
+            elements[i] = values[i];
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n>::Vector(const std::initializer_list<T> &values)
+    constexpr Vector<T, n>::Vector(const std::initializer_list<T> &values) : Storage()
     {
-        elements = new T[n]{};
-        std::copy(values.begin(), values.end(), elements);
+        const T *src = values.begin();
+        for (size_t i = 0; i < n && i < values.size(); i++)
+            elements[i] = src[i];
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n>::Vector(Vector<T, n> &&r_value)
+    template <typename E, typename>
+    constexpr Vector<T, n>::Vector(const E &expr) : Storage()
     {
-        elements = r_value.elements;
-        r_value.elements = nullptr;
+        for (size_t i = 0; i < n; i++)
+            elements[i] = ExprTraits<E>::at(expr, i);
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n>::~Vector()
+    constexpr T& Vector<T, n>::operator[](const size_t &idx)
     {
-        delete[] elements;
+        return elements[idx];
     }
 
     template <typename T, size_t n>
-    inline T& Vector<T, n>::operator[](const size_t &idx) const
+    constexpr const T& Vector<T, n>::operator[](const size_t &idx) const
     {
         return elements[idx];
     }
@@ -98,41 +117,42 @@ namespace Muth
         return std::move(ss.str());
     }
 
+    // Products are widened to Acc before they are summed.
     template <typename T, size_t n>
-    inline T Vector<T, n>::length_square() const
+    template <typename Acc>
+    constexpr Acc Vector<T, n>::length_square() const
     {
-        T result = (T)0;
+        Acc result = (Acc)0;
         for (size_t i = 0; i < n; i++)
-            result += (*this)[i] * (*this)[i];
+            result += Acc((*this)[i]) * Acc((*this)[i]);
         return result;
     }
 
     template <typename T, size_t n>
     inline T Vector<T, n>::length() const
     {
-        if (std::is_same<T, float>::value)
-            return sqrtf(this->length_square());
-        return sqrt(this->length_square());
+        return T(std::sqrt(this->length_square()));
     }
 
     template <typename T, size_t n>
     inline T Vector<T, n>::projection(const Vector<T, n> &vec) const
     {
-        return this->dot(vec) / vec.length();
+        return T(this->dot(vec) / vec.length());
     }
 
     template <typename T, size_t n>
     inline Vector<T, n> Vector<T, n>::projection_vector(const Vector<T, n> &vec) const
     {
-        return std::move(vec.normalized() * this->projection(vec));
+        return vec.normalized() * this->projection(vec);
     }
 
     template <typename T, size_t n>
-    inline T Vector<T, n>::dot(const Vector<T, n> &other) const
+    template <typename Acc>
+    constexpr Acc Vector<T, n>::dot(const Vector<T, n> &other) const
     {
-        T result = (T)0;
+        Acc result = (Acc)0;
         for (size_t i = 0; i < n; i++)
-            result += (*this)[i] * other[i];
+            result += Acc((*this)[i]) * Acc(other[i]);
         return result;
     }
 
@@ -143,34 +163,38 @@ namespace Muth
         T len = this->length();
         for (size_t i = 0; i < n; i++)
             result[i] = (*this)[i] / len;
-        return std::move(result);
+        return result;
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n> &Vector<T, n>::operator=(const Vector<T, n> &src)
+    template <typename E, typename>
+    constexpr Vector<T, n> &Vector<T, n>::operator=(const E &expr)
     {
-        memcpy(elements, src.elements, n * sizeof(T));
+        for (size_t i = 0; i < n; i++)
+            elements[i] = ExprTraits<E>::at(expr, i);
         return *this;
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n> &Vector<T, n>::operator+=(const Vector<T, n> &other)
+    template <typename E, typename>
+    constexpr Vector<T, n> &Vector<T, n>::operator+=(const E &other)
     {
         for (size_t i = 0; i < n; i++)
-            (*this)[i] += other[i];
+            elements[i] += ExprTraits<E>::at(other, i);
         return *this;
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n> &Vector<T, n>::operator-=(const Vector<T, n> &other)
+    template <typename E, typename>
+    constexpr Vector<T, n> &Vector<T, n>::operator-=(const E &other)
     {
         for (size_t i = 0; i < n; i++)
-            (*this)[i] -= other[i];
+            elements[i] -= ExprTraits<E>::at(other, i);
         return *this;
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n> &Vector<T, n>::operator*=(T lambda)
+    constexpr Vector<T, n> &Vector<T, n>::operator*=(T lambda)
     {
         for (size_t i = 0; i < n; i++)
             (*this)[i] *= lambda;
@@ -178,7 +202,7 @@ namespace Muth
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n> &Vector<T, n>::operator/=(T lambda)
+    constexpr Vector<T, n> &Vector<T, n>::operator/=(T lambda)
     {
         for (size_t i = 0; i < n; i++)
             (*this)[i] /= lambda;
@@ -186,63 +210,9 @@ namespace Muth
     }
 
     template <typename T, size_t n>
-    inline Vector<T, n> operator+(const Vector<T, n> &left, const Vector<T, n> &right)
-    {
-        Vector<T, n> result;
-        for (size_t i = 0; i < n; i++)
-            result[i] = left[i] + right[i];
-        return std::move(result);
-    }
-
-    template <typename T, size_t n>
-    inline Vector<T, n> operator-(const Vector<T, n> &left, const Vector<T, n> &right)
-    {
-        Vector<T, n> result;
-        for (size_t i = 0; i < n; i++)
-            result[i] = left[i] - right[i];
-        return std::move(result);
-    }
-
-    template <typename T, size_t n>
-    inline Vector<T, n> operator*(const Vector<T, n> &vec, T lambda)
-    {
-        Vector<T, n> result;
-        for (size_t i = 0; i < n; i++)
-            result[i] = vec[i] * lambda;
-        return std::move(result);
-    }
-
-    template <typename T, size_t n>
-    inline Vector<T, n> operator/(const Vector<T, n> &vec, T lambda)
-    {
-        Vector<T, n> result;
-        for (size_t i = 0; i < n; i++)
-            result[i] = vec[i] / lambda;
-        return std::move(result);
-    }
-
-    template <typename T, size_t n>
-    inline Vector<T, n> operator*(T lambda, const Vector<T, n> &vec)
+    constexpr accumulator_t<T> operator*(const Vector<T, n> &left, const Vector<T, n> &right)
     {
-        Vector<T, n> result;
-        for (size_t i = 0; i < n; i++)
-            result[i] = vec[i] * lambda;
-        return std::move(result);
-    }
-
-    template <typename T, size_t n>
-    inline T operator*(const Vector<T, n> &left, const Vector<T, n> &right)
-    {
-        return std::move(left.dot(right));
-    }
-
-    template <typename T, size_t n>
-    inline Vector<T, n> operator-(const Vector<T, n> &vec)
-    {
-        Vector<T, n> result;
-        for (size_t i = 0; i < n; i++)
-            result[i] = -vec[i];
-        return std::move(result);
+        return left.dot(right);
     }
 
     template <typename T, size_t n>
@@ -250,16 +220,6 @@ namespace Muth
     {
         return out << vec.to_string();
     }
-
-    template<typename T>
-    Vec3<T> cross(Vec3<T> left, Vec3<T> right)
-    {
-        return {
-            left[1] * right[2] - left[2] * right[1],
-            left[2] * right[0] - left[0] * right[2],
-            left[0] * right[1] - left[1] * right[0],
-        };
-    }
 } // namespace Muth
 
 #endif
\ No newline at end of file
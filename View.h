@@ -0,0 +1,668 @@
+#ifndef MUTH_VIEW_H
+#define MUTH_VIEW_H
+
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <sstream>
+#include <type_traits>
+
+#include "NumTool.h"
+#include "MuthException.h"
+#include "Gemm.h"
+#include "Transpose.h"
+#include "Vector.h"
+#include "Matrix.h"
+#include "DynVector.h"
+#include "DynMatrix.h"
+
+namespace Muth
+{
+
+    // Non-owning views over memory held elsewhere: a Matrix, a DynMatrix, a
+    // Vector or a plain buffer. Copying a view copies the pointer, never the
+    // elements, and a view must not outlive what it points at. T may be
+    // const-qualified for read-only views; a view of T converts implicitly to
+    // a view of const T, and containers convert to views of their elements.
+    // Results of arithmetic on views are new DynMatrix / DynVector objects;
+    // the compound assignments write through the view.
+
+    // n elements, element i at elements[i * stride()].
+    template <typename T>
+    struct VectorView
+    {
+    public:
+        using value_type = std::remove_const_t<T>;
+
+        T *elements;
+
+    private:
+        size_t n;
+        size_t inc;
+
+        template <typename C>
+        using Source = std::conditional_t<std::is_const<T>::value, const C, C>;
+
+    public:
+        VectorView() : elements(nullptr), n(0), inc(1) {}
+        VectorView(T *elements, size_t size, size_t stride = 1) : elements(elements), n(size), inc(stride) {}
+        template <typename U, typename = std::enable_if_t<std::is_convertible<U *, T *>::value>>
+        VectorView(const VectorView<U> &other) : elements(other.elements), n(other.size()), inc(other.stride()) {}
+        template <size_t size>
+        VectorView(Vector<value_type, size> &vec) : elements(vec.elements), n(size), inc(1) {}
+        template <size_t size, typename U = T, typename = std::enable_if_t<std::is_const<U>::value>>
+        VectorView(const Vector<value_type, size> &vec) : elements(vec.elements), n(size), inc(1) {}
+        VectorView(Source<DynVector<value_type>> &vec) : elements(vec.elements), n(vec.size()), inc(1) {}
+        VectorView(DynVector<value_type> &&vec) = delete;
+
+        size_t size() const { return n; }
+        size_t stride() const { return inc; }
+        bool contiguous() const { return inc == 1 || n <= 1; }
+
+        T &operator[](const size_t &idx) const { return elements[idx * inc]; }
+        T &get_ref(const size_t &idx) const;
+
+        // count elements starting at start.
+        VectorView<T> slice(size_t start, size_t count) const;
+
+        DynVector<value_type> clone() const;
+        std::string to_string(const std::string &separator = " ") const;
+
+        template <typename Acc = accumulator_t<value_type>>
+        Acc length_square() const;
+        value_type length() const;
+        template <typename Acc = accumulator_t<value_type>>
+        Acc dot(const VectorView<const value_type> &other) const;
+
+        // Copies src's elements into the viewed memory.
+        VectorView<T> &assign(const VectorView<const value_type> &src);
+        VectorView<T> &fill(const value_type &value);
+
+        VectorView<T> &operator+=(const VectorView<const value_type> &other);
+        VectorView<T> &operator-=(const VectorView<const value_type> &other);
+        VectorView<T> &operator*=(value_type lambda);
+        VectorView<T> &operator/=(value_type lambda);
+    };
+
+    // rows() x cols() elements. RowMajor: row r starts at
+    // elements + r * stride(), and each row is contiguous. ColMajor: column c
+    // starts at elements + c * stride(), for Fortran-order buffers and for
+    // transpose(), which is free. Blocks of a larger matrix keep its stride,
+    // so their rows (or columns) are not adjacent.
+    template <typename T, Layout L = Layout::RowMajor>
+    struct MatrixView
+    {
+    public:
+        using value_type = std::remove_const_t<T>;
+        static constexpr Layout layout = L;
+
+        T *elements;
+
+    private:
+        size_t n;
+        size_t m;
+        size_t ld;
+
+        template <typename C>
+        using Source = std::conditional_t<std::is_const<T>::value, const C, C>;
+        template <Layout K>
+        using EnableIfRowMajor = std::enable_if_t<K == Layout::RowMajor>;
+        using RowMajorView = MatrixView<const value_type, Layout::RowMajor>;
+        using ColMajorView = MatrixView<const value_type, Layout::ColMajor>;
+
+    public:
+        MatrixView() : elements(nullptr), n(0), m(0), ld(0) {}
+        MatrixView(T *elements, size_t rows, size_t cols) : elements(elements), n(rows), m(cols), ld(L == Layout::RowMajor ? cols : rows) {}
+        MatrixView(T *elements, size_t rows, size_t cols, size_t stride);
+        template <typename U, typename = std::enable_if_t<std::is_convertible<U *, T *>::value>>
+        MatrixView(const MatrixView<U, L> &other) : elements(other.elements), n(other.rows()), m(other.cols()), ld(other.stride()) {}
+        // Containers store rows contiguously, so only row-major views wrap them.
+        template <size_t rows, size_t cols, Layout K = L, typename = EnableIfRowMajor<K>>
+        MatrixView(Matrix<value_type, rows, cols> &mat) : elements(mat.elements), n(rows), m(cols), ld(cols) {}
+        template <size_t rows, size_t cols, typename U = T, Layout K = L,
+                  typename = std::enable_if_t<std::is_const<U>::value && K == Layout::RowMajor>>
+        MatrixView(const Matrix<value_type, rows, cols> &mat) : elements(mat.elements), n(rows), m(cols), ld(cols) {}
+        template <Layout K = L, typename = EnableIfRowMajor<K>>
+        MatrixView(Source<DynMatrix<value_type>> &mat) : elements(mat.elements), n(mat.rows()), m(mat.cols()), ld(mat.cols()) {}
+        MatrixView(DynMatrix<value_type> &&mat) = delete;
+
+        size_t rows() const { return n; }
+        size_t cols() const { return m; }
+        size_t stride() const { return ld; }
+        bool contiguous() const { return L == Layout::RowMajor ? (ld == m || n <= 1) : (ld == n || m <= 1); }
+
+        T &at(const size_t &row, const size_t &col) const { return elements[row * row_stride(L, ld) + col * col_stride(L, ld)]; }
+        T *operator[](const size_t &row) const;
+        T &get_ref(const size_t &row, const size_t &col) const;
+
+        VectorView<T> row(size_t r) const;
+        VectorView<T> col(size_t c) const;
+        VectorView<T> diagonal() const;
+        // rows x cols elements with (r0, c0) in the top-left corner.
+        MatrixView<T, L> block(size_t r0, size_t c0, size_t rows, size_t cols) const;
+        MatrixView<T, transposed(L)> transpose() const { return MatrixView<T, transposed(L)>(elements, m, n, ld); }
+
+        // Compact row-major copy.
+        DynMatrix<value_type> clone() const;
+        std::string to_string(const std::string &separator = " ", const std::string &end_row = "") const;
+
+        MatrixView<T, L> &assign(const RowMajorView &src) { return copy_from(src); }
+        MatrixView<T, L> &assign(const ColMajorView &src) { return copy_from(src); }
+        MatrixView<T, L> &fill(const value_type &value);
+
+        MatrixView<T, L> &operator+=(const RowMajorView &other) { return update(other, [](T &d, const value_type &s) { d += s; }); }
+        MatrixView<T, L> &operator+=(const ColMajorView &other) { return update(other, [](T &d, const value_type &s) { d += s; }); }
+        MatrixView<T, L> &operator-=(const RowMajorView &other) { return update(other, [](T &d, const value_type &s) { d -= s; }); }
+        MatrixView<T, L> &operator-=(const ColMajorView &other) { return update(other, [](T &d, const value_type &s) { d -= s; }); }
+        MatrixView<T, L> &operator*=(value_type lambda);
+        MatrixView<T, L> &operator/=(value_type lambda);
+
+    private:
+        // Copies across layouts go through the blocked transpose kernel.
+        template <Layout R>
+        MatrixView<T, L> &copy_from(const MatrixView<const value_type, R> &src);
+        // Applies f(dst, src) element-wise, walking this view's storage order
+        // so that at least the destination is read contiguously.
+        template <Layout R, typename F>
+        MatrixView<T, L> &update(const MatrixView<const value_type, R> &src, F f);
+        template <typename F>
+        MatrixView<T, L> &update(F f);
+    };
+
+    // Binary operations take views of either constness over one element type.
+    template <typename L, typename R>
+    using EnableIfSameElement = std::enable_if_t<std::is_same<std::remove_const_t<L>, std::remove_const_t<R>>::value>;
+
+    template <typename T>
+    T &VectorView<T>::get_ref(const size_t &idx) const
+    {
+        if (idx < n)
+            return elements[idx * inc];
+        else
+            throw MuthOutOfRangeException("vector index out of range");
+    }
+
+    template <typename T>
+    VectorView<T> VectorView<T>::slice(size_t start, size_t count) const
+    {
+        if (start > n || count > n - start)
+            throw MuthOutOfRangeException("vector slice out of range");
+        return VectorView<T>(elements + start * inc, count, inc);
+    }
+
+    template <typename T>
+    DynVector<typename VectorView<T>::value_type> VectorView<T>::clone() const
+    {
+        DynVector<value_type> result(n);
+        for (size_t i = 0; i < n; i++)
+            result[i] = elements[i * inc];
+        return result;
+    }
+
+    template <typename T>
+    std::string VectorView<T>::to_string(const std::string &separator /*= " "*/) const
+    {
+        std::stringstream ss;
+        for (size_t i = 0; i < n; i++)
+            ss << elements[i * inc] << separator;
+        return ss.str();
+    }
+
+    template <typename T>
+    template <typename Acc>
+    inline Acc VectorView<T>::length_square() const
+    {
+        return this->template dot<Acc>(*this);
+    }
+
+    template <typename T>
+    inline typename VectorView<T>::value_type VectorView<T>::length() const
+    {
+        return value_type(std::sqrt(this->length_square()));
+    }
+
+    template <typename T>
+    template <typename Acc>
+    inline Acc VectorView<T>::dot(const VectorView<const value_type> &other) const
+    {
+        dyn_check_size(n, other.size());
+        Acc result = (Acc)0;
+        if (contiguous() && other.contiguous())
+        {
+            for (size_t i = 0; i < n; i++)
+                result += Acc(elements[i]) * Acc(other.elements[i]);
+            return result;
+        }
+        for (size_t i = 0; i < n; i++)
+            result += Acc(elements[i * inc]) * Acc(other[i]);
+        return result;
+    }
+
+    template <typename T>
+    VectorView<T> &VectorView<T>::assign(const VectorView<const value_type> &src)
+    {
+        dyn_check_size(n, src.size());
+        for (size_t i = 0; i < n; i++)
+            elements[i * inc] = src[i];
+        return *this;
+    }
+
+    template <typename T>
+    VectorView<T> &VectorView<T>::fill(const value_type &value)
+    {
+        for (size_t i = 0; i < n; i++)
+            elements[i * inc] = value;
+        return *this;
+    }
+
+    template <typename T>
+    inline VectorView<T> &VectorView<T>::operator+=(const VectorView<const value_type> &other)
+    {
+        dyn_check_size(n, other.size());
+        for (size_t i = 0; i < n; i++)
+            elements[i * inc] += other[i];
+        return *this;
+    }
+
+    template <typename T>
+    inline VectorView<T> &VectorView<T>::operator-=(const VectorView<const value_type> &other)
+    {
+        dyn_check_size(n, other.size());
+        for (size_t i = 0; i < n; i++)
+            elements[i * inc] -= other[i];
+        return *this;
+    }
+
+    template <typename T>
+    inline VectorView<T> &VectorView<T>::operator*=(value_type lambda)
+    {
+        for (size_t i = 0; i < n; i++)
+            elements[i * inc] *= lambda;
+        return *this;
+    }
+
+    template <typename T>
+    inline VectorView<T> &VectorView<T>::operator/=(value_type lambda)
+    {
+        for (size_t i = 0; i < n; i++)
+            elements[i * inc] /= lambda;
+        return *this;
+    }
+
+    template <typename T, Layout L>
+    MatrixView<T, L>::MatrixView(T *elements, size_t rows, size_t cols, size_t stride) : elements(elements), n(rows), m(cols), ld(stride)
+    {
+        if (L == Layout::RowMajor ? (stride < cols && rows > 1) : (stride < rows && cols > 1))
+            throw MuthExceptionInvalidOperation("matrix view rows overlap");
+    }
+
+    template <typename T, Layout L>
+    inline T *MatrixView<T, L>::operator[](const size_t &row) const
+    {
+        static_assert(L == Layout::RowMajor, "row pointers need a row-major view; use at() or transpose()");
+        return elements + row * ld;
+    }
+
+    template <typename T, Layout L>
+    T &MatrixView<T, L>::get_ref(const size_t &row, const size_t &col) const
+    {
+        if (row < n && col < m)
+            return at(row, col);
+        else
+            throw MuthOutOfRangeException("matrix index out of range");
+    }
+
+    template <typename T, Layout L>
+    VectorView<T> MatrixView<T, L>::row(size_t r) const
+    {
+        if (r >= n)
+            throw MuthOutOfRangeException("matrix index out of range");
+        return VectorView<T>(elements + r * row_stride(L, ld), m, col_stride(L, ld));
+    }
+
+    template <typename T, Layout L>
+    VectorView<T> MatrixView<T, L>::col(size_t c) const
+    {
+        if (c >= m)
+            throw MuthOutOfRangeException("matrix index out of range");
+        return VectorView<T>(elements + c * col_stride(L, ld), n, row_stride(L, ld));
+    }
+
+    template <typename T, Layout L>
+    VectorView<T> MatrixView<T, L>::diagonal() const
+    {
+        return VectorView<T>(elements, std::min(n, m), ld + 1);
+    }
+
+    template <typename T, Layout L>
+    MatrixView<T, L> MatrixView<T, L>::block(size_t r0, size_t c0, size_t rows, size_t cols) const
+    {
+        if (r0 > n || c0 > m || rows > n - r0 || cols > m - c0)
+            throw MuthOutOfRangeException("matrix block out of range");
+        return MatrixView<T, L>(&at(r0, c0), rows, cols, ld);
+    }
+
+    template <typename T, Layout L>
+    DynMatrix<typename MatrixView<T, L>::value_type> MatrixView<T, L>::clone() const
+    {
+        DynMatrix<value_type> result(n, m);
+        view(result).assign(*this);
+        return result;
+    }
+
+    template <typename T, Layout L>
+    std::string MatrixView<T, L>::to_string(const std::string &separator /*= " "*/, const std::string &end_row /*= ""*/) const
+    {
+        std::stringstream ss;
+        for (size_t r = 0; r < n; r++)
+        {
+            for (size_t c = 0; c < m; c++)
+            {
+                ss << at(r, c) << separator;
+            }
+            ss << end_row;
+        }
+        return ss.str();
+    }
+
+    template <typename T, Layout L>
+    template <Layout R, typename F>
+    inline MatrixView<T, L> &MatrixView<T, L>::update(const MatrixView<const value_type, R> &src, F f)
+    {
+        dyn_check_shape(n, m, src.rows(), src.cols());
+        if (L == Layout::RowMajor)
+        {
+            for (size_t r = 0; r < n; r++)
+                for (size_t c = 0; c < m; c++)
+                    f(elements[r * ld + c], src.at(r, c));
+        }
+        else
+        {
+            for (size_t c = 0; c < m; c++)
+                for (size_t r = 0; r < n; r++)
+                    f(elements[c * ld + r], src.at(r, c));
+        }
+        return *this;
+    }
+
+    template <typename T, Layout L>
+    template <Layout R>
+    MatrixView<T, L> &MatrixView<T, L>::copy_from(const MatrixView<const value_type, R> &src)
+    {
+        if (L == R)
+            return update(src, [](T &d, const value_type &s) { d = s; });
+        dyn_check_shape(n, m, src.rows(), src.cols());
+        // Read as row-major buffers, src's storage is the transpose of ours.
+        if (L == Layout::RowMajor)
+            Muth::transpose(m, n, src.elements, src.stride(), elements, ld);
+        else
+            Muth::transpose(n, m, src.elements, src.stride(), elements, ld);
+        return *this;
+    }
+
+    template <typename T, Layout L>
+    template <typename F>
+    inline MatrixView<T, L> &MatrixView<T, L>::update(F f)
+    {
+        const size_t lines = L == Layout::RowMajor ? n : m;
+        const size_t length = L == Layout::RowMajor ? m : n;
+        for (size_t i = 0; i < lines; i++)
+        {
+            T *line = elements + i * ld;
+            for (size_t j = 0; j < length; j++)
+                f(line[j]);
+        }
+        return *this;
+    }
+
+    template <typename T, Layout L>
+    MatrixView<T, L> &MatrixView<T, L>::fill(const value_type &value)
+    {
+        return update([=](T &d) { d = value; });
+    }
+
+    template <typename T, Layout L>
+    inline MatrixView<T, L> &MatrixView<T, L>::operator*=(value_type lambda)
+    {
+        return update([=](T &d) { d *= lambda; });
+    }
+
+    template <typename T, Layout L>
+    inline MatrixView<T, L> &MatrixView<T, L>::operator/=(value_type lambda)
+    {
+        return update([=](T &d) { d /= lambda; });
+    }
+
+    template <typename T, size_t n>
+    VectorView<T> view(Vector<T, n> &vec) { return VectorView<T>(vec); }
+    template <typename T, size_t n>
+    VectorView<const T> view(const Vector<T, n> &vec) { return VectorView<const T>(vec); }
+    template <typename T>
+    VectorView<T> view(DynVector<T> &vec) { return VectorView<T>(vec); }
+    template <typename T>
+    VectorView<const T> view(const DynVector<T> &vec) { return VectorView<const T>(vec); }
+    template <typename T, size_t n, size_t m>
+    MatrixView<T> view(Matrix<T, n, m> &mat) { return MatrixView<T>(mat); }
+    template <typename T, size_t n, size_t m>
+    MatrixView<const T> view(const Matrix<T, n, m> &mat) { return MatrixView<const T>(mat); }
+    template <typename T>
+    MatrixView<T> view(DynMatrix<T> &mat) { return MatrixView<T>(mat); }
+    template <typename T>
+    MatrixView<const T> view(const DynMatrix<T> &mat) { return MatrixView<const T>(mat); }
+
+    // Views over an external buffer; view<Layout::ColMajor>(...) for
+    // column-major data.
+    template <typename T>
+    VectorView<T> view(T *elements, size_t size, size_t stride = 1) { return VectorView<T>(elements, size, stride); }
+    template <Layout L = Layout::RowMajor, typename T>
+    MatrixView<T, L> view(T *elements, size_t rows, size_t cols, size_t stride) { return MatrixView<T, L>(elements, rows, cols, stride); }
+
+    template <typename T>
+    std::ostream &operator<<(std::ostream &out, const VectorView<T> &vec)
+    {
+        return out << vec.to_string();
+    }
+
+    template <typename T, Layout L>
+    std::ostream &operator<<(std::ostream &out, const MatrixView<T, L> &mat)
+    {
+        return out << mat.to_string();
+    }
+
+    template <typename L, typename R, typename = EnableIfSameElement<L, R>>
+    DynVector<std::remove_const_t<L>> operator+(const VectorView<L> &left, const VectorView<R> &right)
+    {
+        DynVector<std::remove_const_t<L>> result = left.clone();
+        view(result) += right;
+        return result;
+    }
+
+    template <typename L, typename R, typename = EnableIfSameElement<L, R>>
+    DynVector<std::remove_const_t<L>> operator-(const VectorView<L> &left, const VectorView<R> &right)
+    {
+        DynVector<std::remove_const_t<L>> result = left.clone();
+        view(result) -= right;
+        return result;
+    }
+
+    template <typename T>
+    DynVector<std::remove_const_t<T>> operator-(const VectorView<T> &vec)
+    {
+        DynVector<std::remove_const_t<T>> result = vec.clone();
+        result *= std::remove_const_t<T>(-1);
+        return result;
+    }
+
+    template <typename T>
+    DynVector<std::remove_const_t<T>> operator*(const VectorView<T> &vec, std::remove_const_t<T> lambda)
+    {
+        DynVector<std::remove_const_t<T>> result = vec.clone();
+        result *= lambda;
+        return result;
+    }
+
+    template <typename T>
+    DynVector<std::remove_const_t<T>> operator*(std::remove_const_t<T> lambda, const VectorView<T> &vec)
+    {
+        return vec * lambda;
+    }
+
+    template <typename T>
+    DynVector<std::remove_const_t<T>> operator/(const VectorView<T> &vec, std::remove_const_t<T> lambda)
+    {
+        DynVector<std::remove_const_t<T>> result = vec.clone();
+        result /= lambda;
+        return result;
+    }
+
+    template <typename L, typename R, typename = EnableIfSameElement<L, R>>
+    accumulator_t<std::remove_const_t<L>> operator*(const VectorView<L> &left, const VectorView<R> &right)
+    {
+        return left.dot(right);
+    }
+
+    template <typename L, typename R, typename = EnableIfSameElement<L, R>>
+    bool operator==(const VectorView<L> &left, const VectorView<R> &right)
+    {
+        if (left.size() != right.size())
+            return false;
+        for (size_t i = 0; i < left.size(); i++)
+            if (!equal(left[i], right[i]))
+                return false;
+        return true;
+    }
+
+
+    template <typename L, Layout LL, typename R, Layout RL, typename = EnableIfSameElement<L, R>>
+    DynMatrix<std::remove_const_t<L>> operator+(const MatrixView<L, LL> &left, const MatrixView<R, RL> &right)
+    {
+        DynMatrix<std::remove_const_t<L>> result = left.clone();
+        view(result) += right;
+        return result;
+    }
+
+    template <typename L, Layout LL, typename R, Layout RL, typename = EnableIfSameElement<L, R>>
+    DynMatrix<std::remove_const_t<L>> operator-(const MatrixView<L, LL> &left, const MatrixView<R, RL> &right)
+    {
+        DynMatrix<std::remove_const_t<L>> result = left.clone();
+        view(result) -= right;
+        return result;
+    }
+
+    template <typename T, Layout L>
+    DynMatrix<std::remove_const_t<T>> operator-(const MatrixView<T, L> &mat)
+    {
+        DynMatrix<std::remove_const_t<T>> result = mat.clone();
+        result *= std::remove_const_t<T>(-1);
+        return result;
+    }
+
+    template <typename T, Layout L>
+    DynMatrix<std::remove_const_t<T>> operator*(const MatrixView<T, L> &mat, std::remove_const_t<T> lambda)
+    {
+        DynMatrix<std::remove_const_t<T>> result = mat.clone();
+        result *= lambda;
+        return result;
+    }
+
+    template <typename T, Layout L>
+    DynMatrix<std::remove_const_t<T>> operator*(std::remove_const_t<T> lambda, const MatrixView<T, L> &mat)
+    {
+        return mat * lambda;
+    }
+
+    template <typename T, Layout L>
+    DynMatrix<std::remove_const_t<T>> operator/(const MatrixView<T, L> &mat, std::remove_const_t<T> lambda)
+    {
+        DynMatrix<std::remove_const_t<T>> result = mat.clone();
+        result /= lambda;
+        return result;
+    }
+
+    template <typename L, Layout LL, typename R, Layout RL, typename = EnableIfSameElement<L, R>>
+    bool operator==(const MatrixView<L, LL> &left, const MatrixView<R, RL> &right)
+    {
+        if (left.rows() != right.rows() || left.cols() != right.cols())
+            return false;
+        for (size_t r = 0; r < left.rows(); r++)
+            for (size_t c = 0; c < left.cols(); c++)
+                if (!equal(left.at(r, c), right.at(r, c)))
+                    return false;
+        return true;
+    }
+
+    // c += a * b, written through c. Strides and layouts go straight to the
+    // gemm kernels, so blocks of larger matrices and transposed operands
+    // multiply without being copied out first. A column-major c is filled
+    // as c^T += b^T a^T.
+    template <typename T, Layout LC, typename A, Layout LA, typename B, Layout LB, typename = EnableIfSameElement<A, B>,
+              typename = std::enable_if_t<std::is_same<T, std::remove_const_t<A>>::value>>
+    void gemm(const MatrixView<T, LC> &c, const MatrixView<A, LA> &a, const MatrixView<B, LB> &b)
+    {
+        if (a.cols() != b.rows() || c.rows() != a.rows() || c.cols() != b.cols())
+            throw MuthExceptionInvalidOperation("matrix shapes do not match");
+        if (LC == Layout::RowMajor)
+            gemm(a.rows(), a.cols(), b.cols(), a.elements, a.stride(), LA, b.elements, b.stride(), LB, c.elements, c.stride());
+        else
+            gemm(b.cols(), b.rows(), a.rows(), b.elements, b.stride(), transposed(LB), a.elements, a.stride(), transposed(LA), c.elements, c.stride());
+    }
+
+    // y = a * x; y must not overlap a or x. Rows of a row-major a are dot
+    // products, columns of a column-major a are summed into y, so a is
+    // always read along its contiguous direction.
+    template <typename T, typename A, Layout LA, typename X, typename = EnableIfSameElement<A, X>,
+              typename = std::enable_if_t<std::is_same<T, std::remove_const_t<A>>::value>>
+    void gemv(const VectorView<T> &y, const MatrixView<A, LA> &a, const VectorView<X> &x)
+    {
+        using Acc = accumulator_t<T>;
+        if (a.cols() != x.size() || a.rows() != y.size())
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        if (LA == Layout::RowMajor)
+        {
+            for (size_t r = 0; r < a.rows(); r++)
+                y[r] = T(a.row(r).dot(x));
+            return;
+        }
+        std::vector<Acc> sums(a.rows());
+        for (size_t c = 0; c < a.cols(); c++)
+        {
+            const T *column = &a.at(0, c);
+            const Acc k = Acc(x[c]);
+            for (size_t r = 0; r < a.rows(); r++)
+                sums[r] += Acc(column[r]) * k;
+        }
+        for (size_t r = 0; r < a.rows(); r++)
+            y[r] = T(sums[r]);
+    }
+
+    template <typename L, Layout LL, typename R, Layout RL, typename = EnableIfSameElement<L, R>>
+    DynMatrix<std::remove_const_t<L>> operator*(const MatrixView<L, LL> &left, const MatrixView<R, RL> &right)
+    {
+        if (left.cols() != right.rows())
+            throw MuthExceptionInvalidOperation("matrix shapes do not match");
+        DynMatrix<std::remove_const_t<L>> result(left.rows(), right.cols());
+        gemm(view(result), left, right);
+        return result;
+    }
+
+    template <typename L, Layout LL, typename R, typename = EnableIfSameElement<L, R>>
+    DynVector<std::remove_const_t<L>> operator*(const MatrixView<L, LL> &mat, const VectorView<R> &vec)
+    {
+        if (mat.cols() != vec.size())
+            throw MuthExceptionInvalidOperation("matrix and vector shapes do not match");
+        DynVector<std::remove_const_t<L>> result(mat.rows());
+        gemv(view(result), mat, vec);
+        return result;
+    }
+
+    // x^T a, computed as a^T x on the transposed view.
+    template <typename L, typename R, Layout RL, typename = EnableIfSameElement<L, R>>
+    DynVector<std::remove_const_t<L>> operator*(const VectorView<L> &vec, const MatrixView<R, RL> &mat)
+    {
+        return mat.transpose() * vec;
+    }
+
+} // namespace Muth
+
+#endif
\ No newline at end of file
@@ -0,0 +1,493 @@
+// Micro-benchmarks of the hot paths. Every case is timed until it has run
+// for at least --min-time seconds, and global allocations are counted over
+// the timed loop. Results go to stdout (or --out) as JSON or CSV:
+//
+//   muth_bench [--format=json|csv] [--out=FILE] [--filter=TEXT] [--min-time=SECONDS] [--quick]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Muth.h"
+
+namespace
+{
+    std::atomic<size_t> allocation_count{0};
+
+    void *counted_allocate(size_t bytes)
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        if (void *p = std::malloc(bytes ? bytes : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    void *counted_allocate(size_t bytes, std::align_val_t alignment)
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        const size_t align = static_cast<size_t>(alignment);
+        const size_t rounded = (bytes + align - 1) / align * align;
+        if (void *p = std::aligned_alloc(align, rounded ? rounded : align))
+            return p;
+        throw std::bad_alloc();
+    }
+}
+
+void *operator new(size_t bytes) { return counted_allocate(bytes); }
+void *operator new[](size_t bytes) { return counted_allocate(bytes); }
+void *operator new(size_t bytes, std::align_val_t alignment) { return counted_allocate(bytes, alignment); }
+void *operator new[](size_t bytes, std::align_val_t alignment) { return counted_allocate(bytes, alignment); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace MuthBench
+{
+    using namespace Muth;
+
+    // Keeps the optimizer from dropping a result that is never read.
+    template <typename T>
+    inline void keep(const T &value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void *sink;
+        sink = &value;
+#endif
+    }
+
+    struct Result
+    {
+        std::string name;
+        size_t size;
+        size_t iterations;
+        double ns_per_op;
+        double gflops;
+        double allocs_per_op;
+    };
+
+    struct Options
+    {
+        std::string format = "json";
+        std::string out;
+        std::string filter;
+        double min_time = 0.2;
+        bool quick = false;
+    };
+
+    class Runner
+    {
+    public:
+        explicit Runner(const Options &options) : options(options) {}
+
+        // Times op(), growing the iteration count until a run lasts
+        // min_time. flops is the work of one call, 0 when not meaningful.
+        template <typename F>
+        void run(const std::string &name, size_t size, double flops, F &&op);
+
+        const std::vector<Result> &results() const { return results_; }
+
+    private:
+        const Options &options;
+        std::vector<Result> results_;
+    };
+
+    template <typename F>
+    void Runner::run(const std::string &name, size_t size, double flops, F &&op)
+    {
+        const std::string label = name + "/" + std::to_string(size);
+        if (!options.filter.empty() && label.find(options.filter) == std::string::npos)
+            return;
+        using clock = std::chrono::steady_clock;
+        op();
+        size_t iterations = 1;
+        for (;;)
+        {
+            const size_t allocs_before = allocation_count.load(std::memory_order_relaxed);
+            const clock::time_point start = clock::now();
+            for (size_t i = 0; i < iterations; i++)
+                op();
+            const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+            const size_t allocs = allocation_count.load(std::memory_order_relaxed) - allocs_before;
+            if (seconds >= options.min_time || iterations >= (size_t(1) << 40))
+            {
+                const double ns = seconds * 1e9 / double(iterations);
+                results_.push_back({ name, size, iterations, ns, flops > 0 ? flops / ns : 0.0, double(allocs) / double(iterations) });
+                std::fprintf(stderr, "%-28s %12.1f ns/op %8.3f allocs/op\n", label.c_str(), ns, double(allocs) / double(iterations));
+                return;
+            }
+            const double grow = seconds > 0 ? options.min_time / seconds * 1.2 : 10.0;
+            iterations = size_t(double(iterations) * (grow < 2 ? 2 : (grow > 10 ? 10 : grow))) + 1;
+        }
+    }
+
+    // Deterministic fill in [-1, 1).
+    template <typename T>
+    void fill(T *data, size_t count, uint32_t seed)
+    {
+        uint32_t state = seed * 2654435761u + 1u;
+        for (size_t i = 0; i < count; i++)
+        {
+            state = state * 1664525u + 1013904223u;
+            data[i] = T(double(state >> 8) / double(1u << 23) - 1.0);
+        }
+    }
+
+    // ---- Matrix ----
+
+    template <size_t n>
+    void bench_matmul(Runner &runner)
+    {
+        Matrix<double, n, n> a, b;
+        fill(a.elements, n * n, 1);
+        fill(b.elements, n * n, 2);
+        runner.run("matmul_f64", n, 2.0 * n * n * n, [&] {
+            Matrix<double, n, n> c = a * b;
+            keep(c);
+        });
+    }
+
+    template <size_t n>
+    void bench_matmul_f32(Runner &runner)
+    {
+        Matrix<float, n, n> a, b;
+        fill(a.elements, n * n, 3);
+        fill(b.elements, n * n, 4);
+        runner.run("matmul_f32", n, 2.0 * n * n * n, [&] {
+            Matrix<float, n, n> c = a * b;
+            keep(c);
+        });
+    }
+
+    template <size_t n>
+    void bench_matvec(Runner &runner)
+    {
+        Matrix<double, n, n> a;
+        Vector<double, n> v;
+        fill(a.elements, n * n, 5);
+        fill(v.elements, n, 6);
+        runner.run("matvec_f64", n, 2.0 * n * n, [&] {
+            Vector<double, n> r = a * v;
+            keep(r);
+        });
+    }
+
+    // Includes copying the input, which elimination overwrites.
+    template <size_t n>
+    void bench_eliminate(Runner &runner)
+    {
+        Matrix<double, n, n> a;
+        fill(a.elements, n * n, 7);
+        runner.run("gaussian_eliminate_f64", n, 2.0 / 3.0 * n * n * n, [&] {
+            Matrix<double, n, n> tmp = a;
+            tmp.gaussian_eliminate();
+            keep(tmp);
+        });
+    }
+
+    template <size_t n>
+    void bench_det(Runner &runner)
+    {
+        Matrix<double, n, n> a;
+        fill(a.elements, n * n, 8);
+        runner.run("det_f64", n, 0, [&] {
+            double d = a.det();
+            keep(d);
+        });
+    }
+
+    template <size_t n>
+    void bench_inverse(Runner &runner)
+    {
+        Matrix<double, n, n> a;
+        fill(a.elements, n * n, 9);
+        for (size_t i = 0; i < n; i++)
+            a[i][i] += double(n);
+        runner.run("inverse_f64", n, 0, [&] {
+            Matrix<double, n, n> inv = a.inverse();
+            keep(inv);
+        });
+    }
+
+    // Runtime-sized product, once through the global allocator and once
+    // with temporaries in the thread arena.
+    void bench_dyn_matmul(Runner &runner, size_t n)
+    {
+        DynMatrix<double> a(n, n), b(n, n);
+        fill(a.elements, n * n, 10);
+        fill(b.elements, n * n, 11);
+        runner.run("dyn_matmul_f64", n, 2.0 * n * n * n, [&] {
+            DynMatrix<double> c = a * b;
+            keep(c);
+        });
+        runner.run("dyn_matmul_f64_arena", n, 2.0 * n * n * n, [&] {
+            ArenaScope scope;
+            DynMatrix<double> c = a * b;
+            keep(c);
+        });
+    }
+
+    // a^T b through a transposed view against an explicit transpose first.
+    void bench_transposed_matmul(Runner &runner, size_t n)
+    {
+        DynMatrix<double> a(n, n), b(n, n);
+        fill(a.elements, n * n, 12);
+        fill(b.elements, n * n, 13);
+        runner.run("matmul_tn_view_f64", n, 2.0 * n * n * n, [&] {
+            DynMatrix<double> c = view(a).transpose() * view(b);
+            keep(c);
+        });
+        runner.run("matmul_tn_copy_f64", n, 2.0 * n * n * n, [&] {
+            DynMatrix<double> c = a.transform() * b;
+            keep(c);
+        });
+    }
+
+    // Out-of-place transpose into a preallocated matrix, and in place.
+    // Reported flops are elements moved.
+    void bench_transpose(Runner &runner, size_t n)
+    {
+        DynMatrix<double> a(n, n), t(n, n);
+        fill(a.elements, n * n, 14);
+        runner.run("transpose_f64", n, double(n) * n, [&] {
+            transpose(n, n, a.elements, n, t.elements, n);
+            keep(t);
+        });
+        runner.run("transpose_in_place_f64", n, double(n) * n, [&] {
+            a.transform_in_place();
+            keep(a);
+        });
+    }
+
+    // Symmetric eigen decomposition and SVD, with and without vectors.
+    void bench_decompose(Runner &runner, size_t n)
+    {
+        DynMatrix<double> a(n, n);
+        fill(a.elements, n * n, 15);
+        runner.run("sym_eigen_f64", n, 0, [&] {
+            DynSymmetricEigen<double> e(a);
+            keep(e);
+        });
+        runner.run("sym_eigenvalues_f64", n, 0, [&] {
+            DynSymmetricEigen<double> e(a, false);
+            keep(e);
+        });
+        runner.run("svd_f64", n, 0, [&] {
+            DynSVD<double> s(a);
+            keep(s);
+        });
+        runner.run("singular_values_f64", n, 0, [&] {
+            DynSVD<double> s(a, false);
+            keep(s);
+        });
+    }
+
+    // Closed-form 3x3 symmetric eigen decomposition.
+    void bench_sym_eigen3(Runner &runner)
+    {
+        Mat3<float> a;
+        fill(a.elements, 9, 16);
+        a[1][0] = a[0][1];
+        a[2][0] = a[0][2];
+        a[2][1] = a[1][2];
+        runner.run("sym_eigen3_f32", 3, 0, [&] {
+            SymmetricEigen<float, 3> e(a);
+            keep(e);
+        });
+    }
+
+    // ---- Vec3 in bulk ----
+
+    void bench_vec3(Runner &runner, size_t count)
+    {
+        std::vector<Vec3<float>> a(count), b(count), out(count);
+        std::vector<float> coords(count * 6);
+        fill(coords.data(), coords.size(), 12);
+        for (size_t i = 0; i < count; i++)
+        {
+            a[i] = { coords[i * 6], coords[i * 6 + 1], coords[i * 6 + 2] };
+            b[i] = { coords[i * 6 + 3], coords[i * 6 + 4], coords[i * 6 + 5] };
+        }
+        runner.run("vec3_dot_f32", count, 5.0 * count, [&] {
+            float sum = 0;
+            for (size_t i = 0; i < count; i++)
+                sum += a[i].dot(b[i]);
+            keep(sum);
+        });
+        runner.run("vec3_cross_f32", count, 9.0 * count, [&] {
+            for (size_t i = 0; i < count; i++)
+                out[i] = cross(a[i], b[i]);
+            keep(out[0]);
+        });
+        runner.run("vec3_normalize_f32", count, 0, [&] {
+            for (size_t i = 0; i < count; i++)
+                out[i] = a[i].normalized();
+            keep(out[0]);
+        });
+
+        Vec3Batch<float> batch_a(a), batch_b(b), batch_out(count);
+        std::vector<float> dots(count);
+        runner.run("vec3batch_dot_f32", count, 5.0 * count, [&] {
+            dot(batch_a, batch_b, dots);
+            keep(dots[0]);
+        });
+        runner.run("vec3batch_cross_f32", count, 9.0 * count, [&] {
+            cross(batch_a, batch_b, batch_out);
+            keep(batch_out.x[0]);
+        });
+        runner.run("vec3batch_normalize_f32", count, 0, [&] {
+            normalize(batch_a, batch_out);
+            keep(batch_out.x[0]);
+        });
+    }
+
+    void write_json(std::ostream &out, const std::vector<Result> &results)
+    {
+        out << "{\n  \"library\": \"Muth\",\n";
+#if defined(__clang__)
+        out << "  \"compiler\": \"clang " << __clang_major__ << "." << __clang_minor__ << "\",\n";
+#elif defined(__GNUC__)
+        out << "  \"compiler\": \"gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "\",\n";
+#elif defined(_MSC_VER)
+        out << "  \"compiler\": \"msvc " << _MSC_VER << "\",\n";
+#endif
+        out << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result &r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << r.ns_per_op << ", \"gflops\": " << r.gflops << ", \"allocs_per_op\": " << r.allocs_per_op << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+
+    void write_csv(std::ostream &out, const std::vector<Result> &results)
+    {
+        out << "name,size,iterations,ns_per_op,gflops,allocs_per_op\n";
+        for (const Result &r : results)
+            out << r.name << ',' << r.size << ',' << r.iterations << ',' << r.ns_per_op << ',' << r.gflops << ',' << r.allocs_per_op << '\n';
+    }
+
+    bool parse_options(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            auto value = [&](const std::string &key) { return arg.compare(0, key.size(), key) == 0 ? arg.substr(key.size()) : std::string(); };
+            if (arg == "--quick")
+                options.quick = true;
+            else if (!value("--format=").empty())
+                options.format = value("--format=");
+            else if (!value("--out=").empty())
+                options.out = value("--out=");
+            else if (!value("--filter=").empty())
+                options.filter = value("--filter=");
+            else if (!value("--min-time=").empty())
+                options.min_time = std::atof(value("--min-time=").c_str());
+            else
+                return false;
+        }
+        if (options.quick)
+            options.min_time = std::min(options.min_time, 0.02);
+        return options.format == "json" || options.format == "csv";
+    }
+
+} // namespace MuthBench
+
+int main(int argc, char **argv)
+{
+    using namespace MuthBench;
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        std::cerr << "usage: muth_bench [--format=json|csv] [--out=FILE] [--filter=TEXT] [--min-time=SECONDS] [--quick]\n";
+        return 2;
+    }
+
+    Runner runner(options);
+
+    bench_matmul<2>(runner);
+    bench_matmul<3>(runner);
+    bench_matmul<4>(runner);
+    bench_matmul<8>(runner);
+    bench_matmul<16>(runner);
+    bench_matmul<32>(runner);
+    bench_matmul<64>(runner);
+    bench_matmul<128>(runner);
+    bench_matmul<256>(runner);
+    if (!options.quick)
+    {
+        bench_matmul<512>(runner);
+        bench_matmul<1024>(runner);
+    }
+    bench_matmul_f32<4>(runner);
+    bench_matmul_f32<64>(runner);
+
+    bench_matvec<4>(runner);
+    bench_matvec<16>(runner);
+    bench_matvec<64>(runner);
+    bench_matvec<256>(runner);
+    bench_matvec<1024>(runner);
+
+    bench_eliminate<4>(runner);
+    bench_eliminate<16>(runner);
+    bench_eliminate<64>(runner);
+    bench_eliminate<256>(runner);
+
+    bench_det<2>(runner);
+    bench_det<3>(runner);
+    bench_det<4>(runner);
+    bench_det<8>(runner);
+    bench_det<32>(runner);
+    bench_det<128>(runner);
+
+    bench_inverse<3>(runner);
+    bench_inverse<4>(runner);
+    bench_inverse<16>(runner);
+
+    bench_dyn_matmul(runner, 64);
+    bench_dyn_matmul(runner, 256);
+    bench_transposed_matmul(runner, 64);
+    bench_transposed_matmul(runner, 256);
+    bench_transpose(runner, 64);
+    bench_transpose(runner, 1024);
+    if (!options.quick)
+        bench_transpose(runner, 4096);
+    bench_decompose(runner, 64);
+    bench_decompose(runner, 256);
+    bench_sym_eigen3(runner);
+
+    bench_vec3(runner, 4096);
+
+    std::ofstream file;
+    if (!options.out.empty())
+    {
+        file.open(options.out);
+        if (!file)
+        {
+            std::cerr << "cannot open " << options.out << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = options.out.empty() ? std::cout : file;
+    if (options.format == "csv")
+        write_csv(out, runner.results());
+    else
+        write_json(out, runner.results());
+    return 0;
+}